@@ -1,10 +1,14 @@
 #pragma once
 
+#include <bit_parallel_alignment.hpp>
+
 #include <cstdint>
 #include <optional>
 #include <span>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include <seqan3/alphabet/cigar/cigar.hpp>
@@ -48,17 +52,71 @@ public:
 
     // the other one is consumed (should be moved into this function)
     void merge_other_into_this(query_alignments other);
+
+    size_t num_references() const;
+};
+
+// Keeps the alignments of queries between the passes over the queries when the shards of a sharded index are
+// searched one after another. Only the found alignments are stored, and not an (often empty) list per reference.
+// Nothing is written to disk, so the memory grows with the number of alignments of all queries until the last pass.
+// The time spent on the queries in the earlier passes is kept as well, such that the last pass records the totals.
+class collected_query_alignments {
+    using alignment_to_reference = std::tuple<size_t, query_alignment>;
+
+    std::unordered_map<size_t, std::vector<alignment_to_reference>> alignments_by_query_id;
+    std::unordered_map<size_t, size_t> milliseconds_spent_in_search_by_query_id;
+    std::unordered_map<size_t, size_t> milliseconds_spent_in_verification_by_query_id;
+
+public:
+    // the alignments are consumed (should be moved into this function)
+    void add(size_t const query_id, query_alignments alignments);
+
+    // moves all collected alignments of the query into the given alignments and forgets about them
+    void move_into(size_t const query_id, query_alignments& alignments);
+
+    size_t num_queries() const;
+
+    void add_milliseconds_spent_in_search(size_t const query_id, size_t const milliseconds);
+
+    void add_milliseconds_spent_in_verification(size_t const query_id, size_t const milliseconds);
+
+    // returns the time spent on the query in all earlier passes and forgets about it
+    size_t take_milliseconds_spent_in_search(size_t const query_id);
+
+    size_t take_milliseconds_spent_in_verification(size_t const query_id);
 };
 
 enum class alignment_mode {
     only_verify_existance, verify_and_return_alignment_with_cigar, verify_and_return_alignment_without_cigar
 };
 
+// bit_parallel uses a dedicated kernel where possible and falls back to seqan3 otherwise.
+// wavefront uses the wavefront algorithm where possible and falls back to seqan3 otherwise. Alignments with a CIGAR
+// and more errors than automatic would align with the wavefront algorithm are computed by the bit-parallel kernel,
+// because the traceback of the wavefront algorithm needs all wavefronts.
+// automatic aligns with the wavefront algorithm up to the number of errors for which it is estimated to be
+// cheaper than the bit-parallel kernel and uses the bit_parallel implementation for everything else.
+// The existence checks of automatic always use the bit-parallel kernel
+enum class alignment_implementation {
+    bit_parallel, seqan3, wavefront, automatic
+};
+
+alignment_implementation alignment_implementation_from_string(std::string_view const s);
+
+// true if the existence checks of the implementation use the bit-parallel kernel
+bool uses_bit_parallel_kernel(alignment_implementation const implementation);
+
 struct alignment_config {
     size_t const reference_span_offset;
     size_t const num_allowed_errors;
     query_orientation const orientation;
     alignment_mode const mode;
+    alignment_implementation const implementation = alignment_implementation::bit_parallel;
+
+    // precomputed bit-parallel patterns of the query and of the reversed query (see verification::query_profile).
+    // If they are not given, the bit-parallel implementation computes them itself
+    bit_parallel_alignment::query_pattern const* const query_pattern = nullptr;
+    bit_parallel_alignment::query_pattern const* const reverse_query_pattern = nullptr;
 };
 
 enum class alignment_outcome {
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <seqan3/alphabet/cigar/cigar.hpp>
+
+// bit-parallel edit distance computation based on the algorithm of Myers (DOI: https://doi.org/10.1145/316542.316550)
+// in the formulation of Hyyrö (DOI: https://doi.org/10.1007/3-540-45123-4_18).
+// The reference (text) is processed column by column, the query (pattern) is split into blocks of 64 rows.
+// The alignments are semi-global: the query has to be aligned completely, while gaps at
+// the beginning and end of the reference are free.
+namespace bit_parallel_alignment {
+
+static constexpr size_t word_size = 64;
+
+// $, A, C, G, T, N (see input::internal::chars_to_rank_sequence)
+static constexpr size_t rank_alphabet_size = 6;
+
+// a.k.a. Peq, the bitmasks that store for every query position whether it matches a given rank
+class query_pattern {
+public:
+    explicit query_pattern(std::span<const uint8_t> const query);
+
+    size_t length() const;
+
+    size_t num_blocks() const;
+
+    // ranks outside of the rank alphabet never match
+    uint64_t match_mask(size_t const block_index, uint8_t const rank) const {
+        return rank < rank_alphabet_size ? masks[block_index * rank_alphabet_size + rank] : 0;
+    }
+
+private:
+    size_t length_;
+    size_t num_blocks_;
+    std::vector<uint64_t> masks;
+};
+
+enum class sequence_direction {
+    forward, reverse
+};
+
+struct alignment_end {
+    size_t num_errors;
+    // exclusive, in the direction in which the reference was processed
+    size_t end_position;
+};
+
+// The kernels only compute the diagonal band of the reference span in which an alignment with at most
+// max_num_errors errors can exist. Hence, their running time is linear in the length of the reference
+// span times the number of blocks spanned by (reference length - query length + 2 * max_num_errors).
+// For queries with up to max_static_num_blocks blocks, the kernels are specialized for the number of blocks
+// at compile time. Then the loops over the blocks can be unrolled and the DP state is kept on the stack.
+
+// true if the query can be aligned to some part of the reference with at most max_num_errors errors
+bool alignment_exists(
+    std::span<const uint8_t> const reference,
+    query_pattern const& pattern,
+    size_t const max_num_errors
+);
+
+// the number of references that alignments_exist processes at once, one per 64 bit lane of a 256 bit vector
+static constexpr size_t num_lanes = 4;
+
+// like alignment_exists, for every given reference. The references are processed in groups of num_lanes by an
+// inter-sequence vectorized version of the kernel, where every lane holds the DP column of one reference.
+// The band is shared by the lanes of a group, so the references of a group should have similar lengths.
+std::vector<bool> alignments_exist(
+    std::span<const std::span<const uint8_t>> const references,
+    query_pattern const& pattern,
+    size_t const max_num_errors
+);
+
+// the positions at which alignments with at most max_num_errors errors end. Used to restrict the reference span
+// of a longer query part that contains the aligned query.
+struct alignment_end_range {
+    // exclusive, like alignment_end::end_position
+    size_t min_end_position;
+    // the maximum over all of these alignments of (end position - number of errors), but at least 0.
+    // An alignment of a longer query part can only extend behind such an end with its remaining errors.
+    size_t max_end_position_minus_num_errors;
+};
+
+// returns the end range of all alignments with at most max_num_errors errors, if any exists.
+// In contrast to alignment_exists, all columns of the band have to be computed.
+std::optional<alignment_end_range> alignment_end_range_of(
+    std::span<const uint8_t> const reference,
+    query_pattern const& pattern,
+    size_t const max_num_errors
+);
+
+// like alignment_end_range_of, for every given reference. The references are processed like in alignments_exist.
+std::vector<std::optional<alignment_end_range>> alignment_end_ranges(
+    std::span<const std::span<const uint8_t>> const references,
+    query_pattern const& pattern,
+    size_t const max_num_errors
+);
+
+// returns the end of the alignment with the lowest number of errors, if it has at most max_num_errors errors.
+// Ties are broken by choosing the largest end position. If the direction is reverse, both the reference and
+// the query (the pattern must be created from the reversed query) are processed from back to front.
+// This can be used to obtain the start position of the alignment without a traceback.
+// max_num_errors must be smaller than the query length.
+std::optional<alignment_end> best_alignment_end(
+    std::span<const uint8_t> const reference,
+    query_pattern const& pattern,
+    size_t const max_num_errors,
+    sequence_direction const direction
+);
+
+struct alignment_with_cigar {
+    size_t num_errors;
+    size_t start_position;
+    std::vector<seqan3::cigar> cigar;
+};
+
+// returns the alignment with the lowest number of errors and the largest end position, if it has at most
+// max_num_errors errors. The traceback only stores the columns of the band at regularly spaced checkpoints
+// and recomputes the columns between two checkpoints when they are needed. Therefore, the memory usage
+// is in O(sqrt(reference length) * band size + query length) instead of O(reference length * band size).
+// Diagonal steps are preferred over insertions and insertions are preferred over deletions in the traceback.
+// max_num_errors must be smaller than the query length.
+std::optional<alignment_with_cigar> best_alignment_with_cigar(
+    std::span<const uint8_t> const reference,
+    query_pattern const& pattern,
+    size_t const max_num_errors
+);
+
+// like above, but the traceback runs only on a tight window of the reference with the number of errors of the best
+// alignment as the band. The window is found by two score-only passes: a forward pass for the best end and a pass
+// over the reversed sequences in front of it for the start (the reverse_pattern must be created from the reversed
+// query). The first pass is as cheap as best_alignment_end and the others are cheap for low numbers of errors.
+// The result is identical to the one of the version above.
+std::optional<alignment_with_cigar> best_alignment_with_cigar(
+    std::span<const uint8_t> const reference,
+    query_pattern const& pattern,
+    query_pattern const& reverse_pattern,
+    size_t const max_num_errors
+);
+
+namespace internal {
+
+struct block {
+    // vertical deltas, a.k.a. Pv and Mv
+    uint64_t positive_vertical;
+    uint64_t negative_vertical;
+
+    // the score in the last row of this block that belongs to the query
+    size_t score;
+};
+
+// horizontal deltas before shifting them into the next column, a.k.a. Ph and Mh
+struct horizontal_deltas {
+    uint64_t positive;
+    uint64_t negative;
+
+    int delta_at(size_t const bit) const {
+        return static_cast<int>((positive >> bit) & 1) - static_cast<int>((negative >> bit) & 1);
+    }
+};
+
+// computes the next column of the given block, horizontal_input is the score delta of the row above the block
+inline horizontal_deltas advance_block(block& b, uint64_t match_mask, int const horizontal_input) {
+    uint64_t const positive_vertical = b.positive_vertical;
+    uint64_t const negative_vertical = b.negative_vertical;
+
+    uint64_t const vertical_x = match_mask | negative_vertical;
+    if (horizontal_input < 0) {
+        match_mask |= 1;
+    }
+    uint64_t const horizontal_x = (((match_mask & positive_vertical) + positive_vertical) ^ positive_vertical)
+        | match_mask;
+
+    uint64_t positive_horizontal = negative_vertical | ~(horizontal_x | positive_vertical);
+    uint64_t negative_horizontal = positive_vertical & horizontal_x;
+
+    horizontal_deltas const deltas{ .positive = positive_horizontal, .negative = negative_horizontal };
+
+    positive_horizontal <<= 1;
+    negative_horizontal <<= 1;
+    if (horizontal_input < 0) {
+        negative_horizontal |= 1;
+    } else if (horizontal_input > 0) {
+        positive_horizontal |= 1;
+    }
+
+    b.positive_vertical = negative_horizontal | ~(vertical_x | positive_horizontal);
+    b.negative_vertical = positive_horizontal & vertical_x;
+
+    return deltas;
+}
+
+static constexpr size_t dynamic_num_blocks = 0;
+static constexpr size_t max_static_num_blocks = 4;
+
+// the state of the DP matrix for the current column, restricted to the diagonal band (see kernel documentation).
+// If static_num_blocks is not dynamic_num_blocks, it has to be the number of blocks of the pattern
+template<size_t static_num_blocks>
+class banded_columns {
+public:
+    banded_columns(query_pattern const& pattern, size_t const max_num_errors, size_t const reference_length);
+
+    // computes the next column. Returns false if no alignment can end in this or any later column
+    bool advance(uint8_t const rank);
+
+    // the number of computed columns
+    size_t column() const;
+
+    // the score of the last query row in the current column if it is at most max_num_errors
+    std::optional<size_t> last_row_score() const;
+
+    size_t active_blocks_begin() const;
+
+    std::span<const block> active_blocks() const;
+
+    // resets the state to one that was previously obtained from the above functions
+    void restore(size_t const column, size_t const active_blocks_begin, std::span<const block> const active_blocks);
+
+private:
+    size_t num_blocks() const;
+
+    query_pattern const& pattern;
+    size_t const max_num_errors;
+    int64_t const max_diagonal;
+
+    size_t column_;
+    size_t active_blocks_begin_;
+    size_t active_blocks_end_;
+    std::conditional_t<
+        static_num_blocks == dynamic_num_blocks,
+        std::vector<block>,
+        std::array<block, static_num_blocks>
+    > blocks;
+};
+
+size_t score_bit_of(query_pattern const& pattern, size_t const block_index);
+
+// the score of the cell in the given (1-based) query row of a column, given by its active blocks.
+// cells outside of the active blocks get a very large score
+size_t score_in_column(
+    query_pattern const& pattern,
+    size_t const active_blocks_begin,
+    std::span<const block> const active_blocks,
+    size_t const row
+);
+
+// the operations ('=', 'X', 'I', 'D') are given from the end of the alignment to its beginning
+std::vector<seqan3::cigar> run_length_encode(std::vector<char> const& reverse_operations);
+
+} // namespace internal
+
+} // namespace bit_parallel_alignment
@@ -6,38 +6,60 @@
 #include <optional>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include <spdlog/fmt/fmt.h>
 
+namespace sharg {
+
+class parser;
+
+} // namespace sharg
+
 namespace cli {
 
+template<typename T>
+struct cli_option {
+    char const short_id;
+    std::string const long_id;
+    T value;
+
+    std::string command_line_call() const {
+        if constexpr (std::is_same<T, std::filesystem::path>::value) {
+            return fmt::format(
+                " --{} {}{}",
+                long_id,
+                value.has_parent_path() ? ".../" : "",
+                value.filename().c_str()
+            );
+        } else if constexpr (std::is_same<T, bool>::value) {
+            return fmt::format(" --{}", long_id);
+        } else {
+            return fmt::format(" --{} {}", long_id, value);
+        }
+    }
+};
+
+// the options of the index construction, which floxer and floxer_index both offer with the same validation
+struct index_construction_options {
+    cli_option<std::string> occurrence_table{ 'O', "occurrence-table", "epr_v2_16" };
+    cli_option<size_t> suffix_array_sampling_rate{ 'A', "suffix-array-sampling-rate", 4 };
+    cli_option<size_t> min_stripped_n_run_length{ 'N', "strip-n-runs", 0 };
+    cli_option<size_t> kmer_table_length{ 'K', "kmer-table-length", 0 };
+    cli_option<size_t> index_shard_size{ 'Z', "index-shard-size", 0 };
+
+    void add_to(sharg::parser& parser, bool const advanced);
+
+    // the long ids of the options that were changed from their defaults and only apply to newly built indices.
+    // The k-mer table length is not one of them, because the table is also built for a loaded index
+    std::vector<std::string> changed_options_of_new_indices() const;
+};
+
 // the reasons for this whole wrapper class around the sharg parser are the following:
 // - isolating sharg into one compile unit to not always recompile it
 // - providing a clean interface for the application, because sharg does not support std::optional
 // - simplify export of given command line parameters (command_line_call function)
 class command_line_input {
-    template<typename T>
-    struct cli_option {
-        char const short_id;
-        std::string const long_id;
-        T value;
-
-        std::string command_line_call() const {
-            if constexpr (std::is_same<T, std::filesystem::path>::value) {
-                return fmt::format(
-                    " --{} {}{}",
-                    long_id,
-                    value.has_parent_path() ? ".../" : "",
-                    value.filename().c_str()
-                );
-            } else if constexpr (std::is_same<T, bool>::value) {
-                return fmt::format(" --{}", long_id);
-            } else {
-                return fmt::format(" --{} {}", long_id, value);
-            }
-        }
-    };
-
     cli_option<std::filesystem::path> reference_path_{ 'r', "reference", "" };
     cli_option<std::filesystem::path> queries_path_{ 'q', "queries", "" };
     cli_option<std::filesystem::path> output_path_{ 'o', "output", "" };
@@ -55,14 +77,20 @@ class command_line_input {
     cli_option<std::string> anchor_choice_strategy_{ 'y', "anchor-choice-strategy", "round_robin" };
     cli_option<size_t> seed_sampling_step_size_{ 'C', "seed-sampling-step-size", 1 };
     cli_option<bool> dont_erase_useless_anchors_{ 'E', "dont-erase-useless-anchors", false };
+    cli_option<bool> interleaved_seed_search_{ 'B', "interleaved-seed-search", false };
+    cli_option<bool> joint_strand_search_{ 'J', "joint-strand-search", false };
+    index_construction_options index_construction_options_{};
+    cli_option<std::string> shard_search_{ 'U', "shard-search", "all_resident" };
 
     cli_option<bool> bottom_up_pex_tree_building_{ 'b', "bottom-up-pex-tree", false };
     cli_option<bool> use_interval_optimization_{ 'I', "interval-optimization", false };
     cli_option<double> extra_verification_ratio_{ 'v', "extra-verification-ratio", 0.05 };
     cli_option<bool> direct_full_verification_{ 'd', "direct-full-verification", false };
+    cli_option<bool> incremental_verification_{ 'n', "incremental-verification", false };
 
     cli_option<size_t> num_anchors_per_verification_task_{ 'u', "num-anchors-per-task", 3000 };
     cli_option<bool> without_cigar_{ 'w', "without-cigar", false };
+    cli_option<std::string> alignment_implementation_{ 'a', "alignment-implementation", "bit_parallel" };
 
     cli_option<size_t> num_threads_{ 't', "threads", 1 };
     cli_option<size_t> timeout_seconds_{ 'x', "timeout", 0 };
@@ -89,14 +117,25 @@ public:
     std::string anchor_choice_strategy() const;
     size_t seed_sampling_step_size() const;
     bool dont_erase_useless_anchors() const;
+    bool interleaved_seed_search() const;
+    size_t kmer_table_length() const;
+    bool joint_strand_search() const;
+    std::string occurrence_table() const;
+    size_t suffix_array_sampling_rate() const;
+    size_t min_stripped_n_run_length() const;
+    size_t index_shard_size() const;
+    std::vector<std::string> changed_options_of_new_indices() const;
+    std::string shard_search() const;
 
     bool bottom_up_pex_tree_building() const;
     bool use_interval_optimization() const;
     double extra_verification_ratio() const;
     bool direct_full_verification() const;
+    bool incremental_verification() const;
 
     size_t num_anchors_per_verification_task() const;
     bool without_cigar() const;
+    std::string alignment_implementation() const;
 
     size_t num_threads() const;
     std::optional<size_t> timeout_seconds() const;
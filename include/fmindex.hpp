@@ -1,10 +1,291 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
 #include <fmindex-collection/fmindex/BiFMIndex.h>
 #include <fmindex-collection/fmindex/BiFMIndexCursor.h>
 #include <fmindex-collection/occtable/EPR.h>
 
+#include <cereal/types/base_class.hpp>
+#include <cereal/types/vector.hpp>
+
 size_t constexpr Sigma = 6; // DNA + N + $ (Sentinel)
+size_t constexpr dna4_sigma = 5; // DNA + $ (Sentinel)
+
+// The texts of this index are fragments of the references, which are found by removing the runs of N that have
+// at least a minimum length. Long runs of N (e.g. the gaps of assemblies) make up a large part of some references,
+// and removing them reduces the size, construction time and memory of the index. Shorter runs are kept in the text.
+// locate maps the fragments back to the references, so the coordinates are the same as without removing anything.
+// If nothing was removed, the fragment table is empty and the texts are the references.
+template<typename base_index_t_>
+class fragmented_fmindex : public base_index_t_ {
+public:
+    using base_index_t = base_index_t_;
+
+    // the rank of N in the sequences that are given to the constructor
+    static constexpr uint8_t n_rank = 5;
+
+    // If the alphabet of the index doesn't contain N, all runs of N are removed
+    static constexpr bool has_n_in_alphabet = base_index_t::Sigma > n_rank;
+
+    // for min_stripped_n_run_length
+    static constexpr size_t keep_all_n_runs = 0;
+
+    struct fragment {
+        size_t reference_id;
+        // of the first character of the fragment
+        size_t reference_position;
+
+        template<class Archive>
+        void serialize(Archive& archive) {
+            archive(reference_id, reference_position);
+        }
+    };
+
+    fragmented_fmindex() = default;
+
+    template<typename sequences_t>
+    fragmented_fmindex(
+        sequences_t const& sequences,
+        size_t const suffix_array_sampling_rate,
+        size_t const num_threads,
+        size_t const min_stripped_n_run_length = keep_all_n_runs
+    ) : fragmented_fmindex(
+            split_at_n_runs(sequences, has_n_in_alphabet ? min_stripped_n_run_length : 1),
+            suffix_array_sampling_rate,
+            num_threads
+        ) {}
+
+    // (reference id, position), like locate of the base index
+    std::tuple<size_t, size_t> locate(size_t const suffix_array_row) const {
+        auto const [text_id, position_in_text] = base_index_t::locate(suffix_array_row);
+        return reference_position_of(text_id, position_in_text);
+    }
+
+    std::tuple<size_t, size_t> reference_position_of(size_t const text_id, size_t const position_in_text) const {
+        if (fragments.empty()) {
+            return { text_id, position_in_text };
+        }
+
+        auto const& f = fragments[text_id];
+        return { f.reference_id, f.reference_position + position_in_text };
+    }
+
+    std::vector<fragment> const& get_fragments() const {
+        return fragments;
+    }
+
+    template<class Archive>
+    void serialize(Archive& archive) {
+        archive(cereal::base_class<base_index_t>(this), fragments);
+    }
+
+private:
+    struct split_sequences {
+        std::vector<fragment> fragments;
+        std::vector<std::span<const uint8_t>> sequences;
+    };
+
+    template<typename sequences_t>
+    static split_sequences split_at_n_runs(sequences_t const& sequences, size_t const min_stripped_n_run_length) {
+        split_sequences split{};
+        size_t reference_id = 0;
+
+        for (auto const& sequence : sequences) {
+            std::span<const uint8_t> const reference(sequence);
+
+            auto const add_fragment = [&] (size_t const begin, size_t const end) {
+                if (begin < end) {
+                    split.fragments.emplace_back(fragment {
+                        .reference_id = reference_id,
+                        .reference_position = begin
+                    });
+                    split.sequences.emplace_back(reference.subspan(begin, end - begin));
+                }
+            };
+
+            size_t fragment_begin = 0;
+            size_t position = 0;
+
+            while (min_stripped_n_run_length != keep_all_n_runs && position < reference.size()) {
+                if (reference[position] != n_rank) {
+                    ++position;
+                    continue;
+                }
+
+                auto const run_end = static_cast<size_t>(std::ranges::find_if(
+                    reference.subspan(position),
+                    [] (uint8_t const rank) { return rank != n_rank; }
+                ) - reference.begin());
+
+                if (run_end - position >= min_stripped_n_run_length) {
+                    add_fragment(fragment_begin, position);
+                    fragment_begin = run_end;
+                }
+
+                position = run_end;
+            }
+
+            add_fragment(fragment_begin, reference.size());
+
+            ++reference_id;
+        }
+
+        bool const texts_are_references = split.fragments.size() == reference_id &&
+            std::ranges::all_of(std::views::iota(size_t{0}, reference_id), [&split] (size_t const i) {
+                return split.fragments[i].reference_id == i && split.fragments[i].reference_position == 0;
+            });
+
+        if (texts_are_references) {
+            split.fragments.clear();
+        }
+
+        return split;
+    }
+
+    fragmented_fmindex(split_sequences split, size_t const suffix_array_sampling_rate, size_t const num_threads)
+        : base_index_t(split.sequences, suffix_array_sampling_rate, num_threads),
+        fragments{std::move(split.fragments)} {}
+
+    std::vector<fragment> fragments;
+};
+
+using fmindex_epr_v2_8 = fragmented_fmindex<
+    fmindex_collection::BiFMIndex<fmindex_collection::occtable::EprV2_8<Sigma>>
+>;
+using fmindex_epr_v2_16 = fragmented_fmindex<
+    fmindex_collection::BiFMIndex<fmindex_collection::occtable::EprV2_16<Sigma>>
+>;
+using fmindex_epr_v2_32 = fragmented_fmindex<
+    fmindex_collection::BiFMIndex<fmindex_collection::occtable::EprV2_32<Sigma>>
+>;
+
+// the default index, which is also used by the tools that don't let the user choose the occurrence table
 using Table = fmindex_collection::occtable::EprV2_16<Sigma>;
-using fmindex = fmindex_collection::BiFMIndex<Table>;
-using fmindex_cursor = fmindex_collection::BiFMIndexCursor<fmindex>;
+using fmindex = fmindex_epr_v2_16;
+
+// An index over only A, C, G and T, such that the occurrence table doesn't need the (rare) N.
+// All runs of N are removed from its texts, so occurrences that overlap an N of a reference are not found.
+using fmindex_dna4 = fragmented_fmindex<
+    fmindex_collection::BiFMIndex<fmindex_collection::occtable::EprV2_16<dna4_sigma>>
+>;
+
+template<typename index_t>
+using cursor_of_index_t = fmindex_collection::BiFMIndexCursor<index_t>;
+
+using fmindex_cursor = cursor_of_index_t<fmindex>;
+
+// false if the sequence contains a character that is not part of the alphabet of the index (N for the DNA4 index)
+template<typename index_t>
+bool is_in_alphabet_of_index(std::span<const uint8_t> const sequence) {
+    return std::ranges::all_of(sequence, [] (uint8_t const rank) { return rank < index_t::Sigma; });
+}
+
+// The occurrence tables that floxer can build an index with. They differ in the width of the block counters of
+// the EPR table, which trades the memory of the index against the speed of the rank queries, and in the alphabet.
+// The values are stored in the index files and must therefore never change.
+enum class occurrence_table_variant : uint8_t {
+    epr_v2_8 = 0, epr_v2_16 = 1, epr_v2_32 = 2, epr_v2_16_dna4 = 3
+};
+
+occurrence_table_variant occurrence_table_variant_from_string(std::string_view const s);
+
+std::string to_string(occurrence_table_variant const variant);
+
+// the alternatives are in the order of the values of occurrence_table_variant
+using fmindex_variant = std::variant<fmindex_epr_v2_8, fmindex_epr_v2_16, fmindex_epr_v2_32, fmindex_dna4>;
+
+occurrence_table_variant occurrence_table_variant_of(fmindex_variant const& index);
+
+// a default constructed index of the given variant, e.g. to deserialize an index into
+fmindex_variant empty_fmindex(occurrence_table_variant const variant);
+
+template<typename sequences_t>
+fmindex_variant build_fmindex(
+    occurrence_table_variant const variant,
+    sequences_t const& sequences,
+    size_t const suffix_array_sampling_rate,
+    size_t const num_threads,
+    size_t const min_stripped_n_run_length = fmindex::keep_all_n_runs
+) {
+    switch (variant) {
+        case occurrence_table_variant::epr_v2_8:
+            return fmindex_variant(
+                std::in_place_type<fmindex_epr_v2_8>,
+                sequences,
+                suffix_array_sampling_rate,
+                num_threads,
+                min_stripped_n_run_length
+            );
+        case occurrence_table_variant::epr_v2_16:
+            return fmindex_variant(
+                std::in_place_type<fmindex_epr_v2_16>,
+                sequences,
+                suffix_array_sampling_rate,
+                num_threads,
+                min_stripped_n_run_length
+            );
+        case occurrence_table_variant::epr_v2_32:
+            return fmindex_variant(
+                std::in_place_type<fmindex_epr_v2_32>,
+                sequences,
+                suffix_array_sampling_rate,
+                num_threads,
+                min_stripped_n_run_length
+            );
+        case occurrence_table_variant::epr_v2_16_dna4:
+            return fmindex_variant(
+                std::in_place_type<fmindex_dna4>,
+                sequences,
+                suffix_array_sampling_rate,
+                num_threads,
+                min_stripped_n_run_length
+            );
+        default:
+            throw std::runtime_error("(should be unreachable) internal bug in the index construction - occurrence table");
+    }
+}
+
+// Index files start with this marker, followed by the occurrence table variant as a single byte.
+// Files without a marker were written by older versions and contain an index with the EPR v2 16 bit table.
+// In files with the first marker, only the DNA4 index has a fragment table.
+static constexpr std::string_view index_file_marker = "floxer index v2\n";
+static constexpr std::string_view index_file_marker_v1 = "floxer index v1\n";
+
+// References that are too large for one index are split into shards, which are the indices of consecutive ranges
+// of the references. The file of a sharded index starts with this marker, followed by the ranges of the shards.
+// Every shard is stored in an index file of its own.
+static constexpr std::string_view index_shards_file_marker = "floxer index shards v1\n";
+
+struct index_shard_range {
+    size_t first_reference_id;
+    size_t num_references;
+
+    template<class Archive>
+    void serialize(Archive& archive) {
+        archive(first_reference_id, num_references);
+    }
+};
+
+// (reference id, position), like the result of fmindex::locate
+using locate_result = std::tuple<size_t, size_t>;
+
+// The same as calling index.locate for every given suffix array row, the results are in the same order as the rows.
+// Every locate walks along the LF-mapping until it reaches a sampled row, and every step depends on a (usually
+// cache-missing) access to the occurrence table. Here, the walks of many rows are advanced in lock-step. The steps
+// of different walks are independent, so the CPU can have the cache misses of many walks in flight at the same time.
+// Instantiated for all alternatives of fmindex_variant.
+template<typename index_t>
+std::vector<locate_result> locate_batch(index_t const& index, std::span<const size_t> const suffix_array_rows);
+
+std::vector<locate_result> locate_batch(fmindex_variant const& index, std::span<const size_t> const suffix_array_rows);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <fmindex.hpp>
+#include <input.hpp>
+#include <kmer_cursor_table.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace index_construction {
+
+struct index_config {
+    occurrence_table_variant occurrence_table;
+    size_t suffix_array_sampling_rate;
+    size_t min_stripped_n_run_length;
+    size_t num_threads;
+};
+
+// the index is built from unpacked rank sequences, which take 4 times the memory of the packed references
+std::vector<std::vector<uint8_t>> unpack_references(input::references const& references);
+
+fmindex_variant build_index(
+    std::vector<std::vector<uint8_t>> const& unpacked_references,
+    index_config const& config
+);
+
+// unpacks the references only for the construction of the index
+fmindex_variant build_index(input::references const& references, index_config const& config);
+
+kmer_cursor_table build_kmer_table(fmindex_variant const& index, size_t const kmer_length);
+
+// Splits the references into consecutive ranges with at most max_shard_length bases in total. A reference that is
+// longer than max_shard_length gets a shard of its own.
+std::vector<index_shard_range> partition_references_into_shards(
+    input::references const& references,
+    size_t const max_shard_length
+);
+
+std::vector<std::vector<uint8_t>> unpack_references(
+    input::references const& references,
+    index_shard_range const shard_range
+);
+
+// The shards are built and saved one after another, such that at most the index of one shard is in memory.
+// Afterwards, the ranges of the shards are saved to the index path. If kmer_table_length is not 0,
+// the k-mer table of every shard is stored in its file.
+void build_and_save_index_shards(
+    input::references const& references,
+    std::vector<index_shard_range> const& shard_ranges,
+    index_config const& config,
+    size_t const kmer_table_length,
+    std::filesystem::path const& index_path
+);
+
+} // namespace index_construction
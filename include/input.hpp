@@ -2,11 +2,14 @@
 
 #include <floxer_cli.hpp>
 #include <fmindex.hpp>
+#include <kmer_cursor_table.hpp>
+#include <packed_rank_sequence.hpp>
 
 #include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <ivio/ivio.h>
@@ -15,7 +18,7 @@ namespace input {
 
 struct reference_record {
     std::string const id;
-    std::vector<uint8_t> const rank_sequence;
+    packed_rank_sequence const rank_sequence;
     size_t const internal_id;
 };
 
@@ -38,9 +41,11 @@ public:
 
     std::optional<query_record> next();
 
-private:
+    // longer queries are skipped
     static constexpr size_t MAX_ALLOWED_QUERY_LENGTH = 100'000;
 
+private:
+
     ivio::fastq::reader reader;
     size_t num_queries_read;
     cli::command_line_input const& cli_input;
@@ -48,13 +53,37 @@ private:
 
 references read_references(std::filesystem::path const& reference_sequence_path);
 
-fmindex load_index(std::filesystem::path const& _index_path);
+// The references are stored in a file next to the index file, such that a run with an existing index doesn't need
+// to parse the reference FASTA file. The file starts with this marker, followed by the ids and packed rank sequences.
+static constexpr std::string_view references_file_marker = "floxer references v2\n";
+
+std::filesystem::path references_path_of_index(std::filesystem::path const& index_path);
+
+// std::nullopt if the file doesn't exist or was written by an older version (e.g. next to older index files).
+// Throws if the file is damaged, e.g. truncated
+std::optional<references> load_references(std::filesystem::path const& references_path);
+
+// the index is loaded with the occurrence table that is recorded in the file
+fmindex_variant load_index(std::filesystem::path const& _index_path);
+
+// also loads the k-mer table that is stored after the index. It stays empty for index files without a table
+fmindex_variant load_index(std::filesystem::path const& _index_path, kmer_cursor_table& out_kmer_table);
+
+// std::nullopt if the file contains an index of all references instead of the ranges of the shards of a sharded index
+std::optional<std::vector<index_shard_range>> load_index_shard_ranges(std::filesystem::path const& index_path);
+
+// the index file of a shard of the sharded index with the given path
+std::filesystem::path shard_path_of_index(std::filesystem::path const& index_path, size_t const shard_id);
 
 // the number of errors allowed for this a queries alignment (edit distance)
 // it was either directly given by the user, or is calculated using the given
 // error probability
 size_t num_errors_from_user_config(size_t const query_length, cli::command_line_input const& cli_input);
 
+// false in two cases that likely don't occur in practice, where the errors are configured in a way such that the
+// alignment algorithm makes no sense. Queries of such a length are skipped
+bool num_errors_fit_query_length(size_t const query_length, cli::command_line_input const& cli_input);
+
 namespace internal {
 
 // it is assumed that the record id is the start of the tag until the first space
@@ -65,6 +94,8 @@ std::string extract_record_id(std::string_view const& record_tag);
 // this means that this program currently can't accurately handle IUPAC degenerate chars
 std::vector<uint8_t> chars_to_rank_sequence(std::string_view const chars);
 
+std::vector<uint8_t> reverse_complement_rank_sequence(std::vector<uint8_t> const& rank_sequence);
+
 } // namespace internal
 
 } // namespace input
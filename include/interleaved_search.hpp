@@ -0,0 +1,59 @@
+#pragma once
+
+#include <fmindex.hpp>
+#include <kmer_cursor_table.hpp>
+#include <search.hpp>
+
+#include <span>
+#include <vector>
+
+#include <search_schemes/Scheme.h>
+
+// An approximate search of many seeds at once with search schemes and edit distance, as an alternative to searching
+// the seeds one after another with search_ng21::search_n of fmindex-collection.
+// Every search of the scheme of every seed is a depth-first traversal with its own explicit stack. A window of these
+// traversals is advanced in an interleaved fashion (one node per traversal and turn, similar to coroutines).
+// The rank queries of different traversals are independent, so the CPU can have the cache misses of many of them
+// in flight at the same time, instead of every step waiting for its own cache miss.
+namespace interleaved_search {
+
+struct seed_search_result {
+    // can contain overlapping groups, like the ones reported by search_n
+    std::vector<search::internal::anchor_group> anchor_groups;
+    size_t total_num_raw_anchors;
+};
+
+// The search schemes must be expanded to the lengths of the seeds. Like search_n, the search of a seed stops
+// as soon as it reported at least max_num_raw_anchors_per_seed anchors.
+// Searches that start with an exact match of at least k characters start at the cursor of that k-mer in the table.
+// The table can be empty. Seeds with characters that are not part of the alphabet of the index are not searched.
+// Indels at the very ends of the seeds and directly adjacent insertions and deletions are not searched, because
+// such occurrences are also found with the same or fewer errors in a slightly different form.
+// Both functions are instantiated for all alternatives of fmindex_variant.
+template<typename index_t>
+std::vector<seed_search_result> search_seeds(
+    index_t const& index,
+    kmer_cursor_table const& kmer_table,
+    std::span<const search::seed> const seeds,
+    std::span<search_schemes::Scheme const* const> const search_schemes_of_seeds,
+    size_t const max_num_raw_anchors_per_seed
+);
+
+struct both_orientations_result {
+    std::vector<seed_search_result> forward;
+    std::vector<seed_search_result> reverse_complement;
+};
+
+// Searches the seeds and their reverse complements with a single traversal per search of the scheme, by extending
+// a second cursor in the opposite direction with the complemented characters. The results of the reverse complement
+// of seeds[i] are stored at index i. The limit of anchors applies to both orientations separately.
+template<typename index_t>
+both_orientations_result search_seeds_of_both_orientations(
+    index_t const& index,
+    kmer_cursor_table const& kmer_table,
+    std::span<const search::seed> const seeds,
+    std::span<search_schemes::Scheme const* const> const search_schemes_of_seeds,
+    size_t const max_num_raw_anchors_per_seed
+);
+
+} // namespace interleaved_search
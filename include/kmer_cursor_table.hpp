@@ -0,0 +1,60 @@
+#pragma once
+
+#include <fmindex.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// The bidirectional FM index cursors of all 4^k k-mers over A, C, G and T (ranks 1 to 4), such that a search
+// that starts with an exact match of k characters can start at depth k instead of at the root.
+// Every entry takes 24 bytes, so the table takes 24 * 4^k bytes (e.g. 400 MB for k = 12).
+class kmer_cursor_table {
+public:
+    // an empty table, without any k-mers
+    kmer_cursor_table() = default;
+
+    // instantiated for all alternatives of fmindex_variant
+    template<typename index_t>
+    kmer_cursor_table(index_t const& index, size_t const kmer_length);
+
+    // 0 for the empty table
+    size_t kmer_length() const;
+
+    bool empty() const;
+
+    // std::nullopt if the k-mer contains a rank outside of A, C, G and T.
+    // The k-mer must have the length of the k-mers of the table
+    template<typename index_t>
+    std::optional<cursor_of_index_t<index_t>> cursor_of(
+        index_t const& index,
+        std::span<const uint8_t> const kmer
+    ) const;
+
+    template<class Archive>
+    void serialize(Archive& archive) {
+        archive(kmer_length_, entries);
+    }
+
+private:
+    struct entry {
+        size_t suffix_array_begin;
+        size_t reverse_suffix_array_begin;
+        size_t count;
+
+        template<class Archive>
+        void serialize(Archive& archive) {
+            archive(suffix_array_begin, reverse_suffix_array_begin, count);
+        }
+    };
+
+    template<typename cursor_t>
+    void fill_entries(cursor_t const& cursor, size_t const depth, size_t const kmer_code);
+
+    size_t kmer_length_ = 0;
+
+    // indexed by the k-mers, interpreted as base 4 numbers with the first character as the most significant digit
+    std::vector<entry> entries{};
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+// defines __GLIBC__
+#include <cstddef>
+
+// Functions annotated with FLOXER_MULTIVERSIONED are compiled once for every x86-64 microarchitecture level
+// (v4: AVX-512, v3: AVX2, v2: up to SSE4.2, default: baseline) and the best version for the CPU is selected
+// once at program startup (via CPUID and GNU indirect functions).
+// This way, a single portable binary uses e.g. AVX2 on the machines that support it.
+// All calls inside of an annotated function are inlined (flatten), such that the loops of the called
+// functions (including the templates from libraries) are compiled for the selected extension as well.
+// This is only enabled for GCC on x86-64 with glibc (indirect functions) and only if the build does not target
+// AVX already (e.g. with -march=native), everywhere else it has no effect.
+#if defined(__x86_64__) && defined(__GLIBC__) && defined(__GNUC__) && !defined(__clang__) && !defined(__AVX__)
+#define FLOXER_MULTIVERSIONED __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "arch=x86-64-v2", "default"), flatten))
+#else
+#define FLOXER_MULTIVERSIONED
+#endif
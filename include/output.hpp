@@ -4,19 +4,36 @@
 #include <alignment.hpp>
 #include <fmindex.hpp>
 #include <input.hpp>
+#include <kmer_cursor_table.hpp>
 
 #include <chrono>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <string>
+#include <vector>
 
 #include <seqan3/core/debug_stream/tuple.hpp>
 #include <seqan3/io/sam_file/output.hpp>
 
 namespace output {
 
-void save_index(fmindex const& _index, std::filesystem::path const& _index_path);
+// the occurrence table variant is recorded in a header in front of the index,
+// the k-mer table is stored after the index, it can be empty
+void save_index(
+    fmindex_variant const& _index,
+    kmer_cursor_table const& _kmer_table,
+    std::filesystem::path const& _index_path
+);
+
+// in the format of input::load_index_shard_ranges
+void save_index_shard_ranges(
+    std::vector<index_shard_range> const& _shard_ranges,
+    std::filesystem::path const& _index_path
+);
+
+// in the format of input::load_references
+void save_references(input::references const& _references, std::filesystem::path const& _references_path);
 
 using alignment_output_fields_t = seqan3::fields<
     seqan3::field::id,
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <vector>
+
+#include <cereal/types/vector.hpp>
+
+// A rank sequence that stores A, C, G and T (ranks 1 to 4) with 2 bits per character. All other ranks
+// (N and the sentinel) are stored as a sorted list of runs, which is short for references, because
+// they contain few runs of N. Compared to one byte per character, this takes about 4 times less memory.
+class packed_rank_sequence {
+public:
+    packed_rank_sequence() = default;
+
+    explicit packed_rank_sequence(std::span<const uint8_t> const rank_sequence);
+
+    packed_rank_sequence(std::initializer_list<uint8_t> const rank_sequence);
+
+    size_t size() const;
+
+    size_t num_exception_runs() const;
+
+    // writes the ranks from position begin to begin + out.size() of the sequence into out
+    void unpack_into(size_t const begin, std::span<uint8_t> const out) const;
+
+    std::vector<uint8_t> unpack() const;
+
+    template<class Archive>
+    void serialize(Archive& archive) {
+        archive(length, words, exception_runs);
+    }
+
+private:
+    static constexpr size_t characters_per_word = 32;
+
+    // a run of equal ranks that are not A, C, G or T. Their 2 bit codes in the words are 0
+    struct exception_run {
+        size_t position;
+        size_t length;
+        uint8_t rank;
+
+        template<class Archive>
+        void serialize(Archive& archive) {
+            archive(position, length, rank);
+        }
+    };
+
+    size_t length = 0;
+    std::vector<uint64_t> words;
+    std::vector<exception_run> exception_runs;
+};
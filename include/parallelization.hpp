@@ -8,10 +8,13 @@
 #include <pex.hpp>
 #include <search.hpp>
 #include <statistics.hpp>
+#include <verification.hpp>
 #include <atomic>
 #include <stdexcept>
 #include <memory>
+#include <optional>
 #include <variant>
+#include <vector>
 
 #define BS_THREAD_POOL_ENABLE_PRIORITY
 #include <BS_thread_pool.hpp>
@@ -24,11 +27,23 @@ std::vector<search::anchor_package> create_anchor_packages(
     cli::command_line_input const& cli_input
 );
 
+// The queries are aligned in a single pass, unless the shards of a sharded index are searched one after another.
+// Then there is one pass over all queries per shard, and the alignments of the passes before the last one
+// are collected, such that the last pass can write all alignments of a query together.
+struct alignment_pass {
+    mutex_guarded<alignment::collected_query_alignments>* collected_alignments;
+    bool is_last_pass;
+};
+
+static constexpr alignment_pass single_pass{ .collected_alignments = nullptr, .is_last_pass = true };
+
+// with more than one searcher (the shards of a sharded index), every query is searched with all of them
 void spawn_search_task(
     mutex_guarded<input::queries>& queries,
     input::references const& references,
     cli::command_line_input const& cli_input,
-    search::searcher const& searcher,
+    std::vector<search::searcher> const& searchers,
+    alignment_pass const pass,
     mutex_guarded<output::alignment_output>& alignment_output,
     mutex_guarded<statistics::search_and_alignment_statistics>& global_stats,
     BS::thread_pool& thread_pool,
@@ -42,11 +57,18 @@ struct shared_verification_data {
     input::query_record const query;
     input::references const& references;
     pex::pex_tree const pex_tree;
+    // the mirrored PEX tree with the joint strand search, otherwise the same tree as above
+    pex::pex_tree const pex_tree_reverse_complement;
     cli::command_line_input const& cli_input;
     pex::pex_verification_config const config;
+    // built once after the PEX tree and used by all verification tasks, not built for the seqan3 implementation,
+    // which doesn't use them
+    std::optional<verification::query_profile> const query_profile_forward;
+    std::optional<verification::query_profile> const query_profile_reverse_complement;
     intervals::verified_intervals_for_all_references verified_intervals_forward;
     intervals::verified_intervals_for_all_references verified_intervals_reverse_complement;
     mutex_guarded<alignment::query_alignments> all_tasks_alignments;
+    alignment_pass const pass;
     mutex_guarded<output::alignment_output>& alignment_output;
     std::atomic_size_t num_verification_tasks_remaining;
     mutex_guarded<statistics::search_and_alignment_statistics>& global_stats;
@@ -57,7 +79,9 @@ struct shared_verification_data {
         input::query_record const query_,
         input::references const& references_,
         pex::pex_tree const pex_tree_,
+        pex::pex_tree const pex_tree_reverse_complement_,
         cli::command_line_input const& cli_input,
+        alignment_pass const pass_,
         mutex_guarded<output::alignment_output>& alignment_output_,
         size_t const num_verification_tasks,
         mutex_guarded<statistics::search_and_alignment_statistics>& global_stats,
@@ -50,6 +50,8 @@ struct pex_verification_config {
     intervals::use_interval_optimization const use_interval_optimization;
     verification_kind_t const verification_kind;
     double const extra_verification_ratio;
+    alignment::alignment_implementation const alignment_implementation;
+    bool const incremental_verification;
 };
 
 // based on chapter 6.5.1 from the book "Flexible Pattern Matching in Strings" by Navarro and Raffinot
@@ -84,12 +86,20 @@ public:
 
     std::vector<node> const& get_leaves() const;
 
+    // empty if the root is the only leaf
+    std::vector<node> const& get_inner_nodes() const;
+
     // returns seeds in the same order as the leaves are stored in the tree (index in vector = seed_id)
     std::vector<search::seed> generate_seeds(
         std::span<const uint8_t> const query,
         size_t const seed_sampling_step_size
     ) const;
 
+    // The tree for the reverse complement of the query with the same structure and order of leaves. Every node
+    // covers the mirrored span, such that the seed of leaf i in the reverse complement is the reverse complement
+    // of the seed of leaf i in the original query
+    pex_tree mirrored() const;
+
     std::string dot_statement() const;
 
 private:
@@ -125,4 +135,13 @@ private:
     size_t leaf_max_num_errors;
 };
 
+// the search scheme keys of the seeds of the PEX trees for a grid of query lengths up to the maximum allowed query
+// length (every length for short queries, geometrically spaced for long queries), to prewarm the search scheme cache.
+// Only seeds with a length of at most max_seed_length are included, because the expanded schemes of long seeds
+// (the rightmost leaves of the trees of long queries) need a lot of memory and are rarely shared between queries
+std::vector<search::search_scheme_key> predicted_search_scheme_keys(
+    cli::command_line_input const& cli_input,
+    size_t const max_seed_length
+);
+
 } // namespace pex
@@ -2,6 +2,8 @@
 
 #include <alignment.hpp>
 #include <fmindex.hpp>
+#include <kmer_cursor_table.hpp>
+#include <mutex_wrapper.hpp>
 #include <tuple_hash.hpp>
 
 #include <string_view>
@@ -59,6 +61,7 @@ struct search_config {
     anchor_group_order_t const anchor_group_order;
     anchor_choice_strategy_t const anchor_choice_strategy;
     bool const erase_useless_anchors;
+    bool const interleaved_seed_search;
 };
 
 struct anchor_package {
@@ -101,34 +104,87 @@ struct search_result {
     ) const;
 };
 
+// (seed length, number of errors of the seed)
+using search_scheme_key = std::tuple<size_t, size_t>;
+
+// A thread-safe cache for the expanded search schemes, meant to be shared by all searches of the program.
+// The schemes of the keys given to prewarm are read without any locking. All other schemes are created on
+// demand and stored behind a shared mutex. References to the schemes stay valid for the lifetime of the cache.
+class search_scheme_cache {
+public:
+    // must not be called concurrently with any other member function
+    void prewarm(std::span<const search_scheme_key> const keys);
+
+    search_schemes::Scheme const& get(
+        size_t const pex_leaf_query_length,
+        size_t const pex_leaf_num_errors
+    );
+
+    size_t num_prewarmed_schemes() const;
+
+private:
+    using schemes_t = std::unordered_map<search_scheme_key, search_schemes::Scheme>;
+
+    schemes_t prewarmed_schemes;
+    shared_mutex_guarded<schemes_t> schemes_created_on_demand;
+};
+
+struct both_orientations_search_result {
+    search_result forward;
+    search_result reverse_complement;
+};
+
 struct searcher {
-    fmindex const& index;
+    fmindex_variant const& index;
+    search_scheme_cache& scheme_cache;
+    // only used by the interleaved seed search, can be empty
+    kmer_cursor_table const& kmer_table;
+    // of all references, also if the index is a shard that covers only some of them
     size_t const num_reference_sequences;
     search_config const config;
+    // the id of the first reference of the index, which is not 0 for the shards of a sharded index
+    size_t const first_reference_id = 0;
 
     search_result search_seeds(
         std::vector<seed> const& seeds
     ) const;
+
+    // reverse_complement_seeds[i] must be the reverse complement of forward_seeds[i], as generated by the mirrored
+    // PEX tree. With the interleaved seed search, both are searched in the same traversals, otherwise one after another
+    both_orientations_search_result search_seeds_of_both_orientations(
+        std::vector<seed> const& forward_seeds,
+        std::vector<seed> const& reverse_complement_seeds
+    ) const;
 };
 
-namespace internal {
+// Merges the results of searches of the same seeds in the different shards of a sharded index. The shards cover
+// different references, so every reference gets the anchors of a single shard. The caps of the config are applied
+// again to the merged anchors of every seed, such that a seed doesn't get more anchors than with a single index.
+// A seed is fully excluded if it was excluded in any shard or its anchors in all shards exceed the hard cap.
+// Beyond the soft cap, the anchors with the fewest errors are kept.
+search_result merge_search_results_of_shards(
+    std::vector<search_result> results_of_shards,
+    search_config const& config
+);
 
-class search_scheme_cache {
-public:
-    search_schemes::Scheme const& get(
-        size_t const pex_leaf_query_length,
-        size_t const pex_leaf_num_errors
-    );
+namespace internal {
 
-private:
-    std::unordered_map<std::tuple<size_t, size_t>, search_schemes::Scheme> schemes;
-};
+search_schemes::Scheme create_search_scheme(size_t const pex_leaf_query_length, size_t const pex_leaf_num_errors);
 
+// the suffix array rows [suffix_array_begin, suffix_array_end) of occurrences of a seed with num_errors errors
 struct anchor_group {
-    fmindex_cursor cursor;
+    size_t suffix_array_begin;
+    size_t suffix_array_end;
     size_t num_errors;
+
+    size_t count() const;
 };
 
+// Approximate search reports groups with overlapping or nested suffix array intervals. This returns the union of
+// the rows of all given groups as disjoint groups, sorted by suffix array position, such that every row is located
+// only once. Every row belongs to a group with the lowest number of errors among the given groups that contain it
+std::vector<anchor_group> merge_overlapping_anchor_groups(std::vector<anchor_group> anchor_groups);
+
 static inline constexpr size_t erase_marker = std::numeric_limits<size_t>::max();
 
 // returns the number of kept anchors, sorts anchors by position
@@ -1,12 +1,19 @@
 #pragma once
 
 #include <alignment.hpp>
+#include <bit_parallel_alignment.hpp>
 #include <input.hpp>
 #include <intervals.hpp>
 #include <mutex_wrapper.hpp>
 #include <pex.hpp>
 #include <search.hpp>
 #include <statistics.hpp>
+#include <tuple_hash.hpp>
+
+#include <optional>
+#include <span>
+#include <tuple>
+#include <unordered_map>
 
 namespace verification {
 
@@ -14,8 +21,29 @@ namespace internal {
 
 struct span_config;
 
+struct verified_child;
+
 }
 
+// the precomputed bit-parallel patterns of the query spans of all PEX nodes that are verified (all except the leaves)
+// for one orientation of a query. It is created once per query and shared read-only by all verification tasks
+class query_profile {
+public:
+    query_profile(pex::pex_tree const& pex_tree, std::span<const uint8_t> const query);
+
+    bit_parallel_alignment::query_pattern const& pattern_of(pex::pex_tree::node const& pex_node) const;
+
+    // the pattern of the reversed query, for the alignments without CIGAR
+    bit_parallel_alignment::query_pattern const& reverse_root_pattern() const;
+
+private:
+    void add_pattern_of(pex::pex_tree::node const& pex_node, std::span<const uint8_t> const query);
+
+    // by query_index_from and query_index_to of the PEX node
+    std::unordered_map<std::tuple<size_t, size_t>, bit_parallel_alignment::query_pattern> patterns;
+    bit_parallel_alignment::query_pattern reverse_root_pattern_;
+};
+
 // this struct collects the arguments needed to verify the existance of a match between
 // the query and a specific region of the reference, determined by an anchor and the
 // corresponding node of a PEX tree
@@ -28,10 +56,28 @@ private:
 
     void hierarchical_verification();
 
+    // verifies a single node during the hierarchical verification, returns std::nullopt
+    // if the verification can be stopped, because the root was already verified.
+    // In the incremental verification, the reference span is narrowed using the verified child
+    // and the verified child is replaced by this node, if it is an inner node that was verified successfully
+    std::optional<alignment::alignment_outcome> verify_node_of_hierarchy(
+        pex::pex_tree::node const& pex_node,
+        std::optional<internal::verified_child>& verified_child
+    );
+
+    bool uses_incremental_verification() const;
+
     bool root_was_already_verified() const;
 
     internal::span_config compute_root_reference_span_config() const;
 
+    internal::span_config compute_reference_span_config_of(
+        pex::pex_tree::node const& pex_node,
+        std::optional<internal::verified_child> const& verified_child
+    ) const;
+
+    friend struct batched_query_verifier;
+
 public:
     pex::pex_tree const& pex_tree;
     search::anchor_t const& anchor;
@@ -43,12 +89,47 @@ public:
     shared_mutex_guarded<intervals::verified_intervals>& already_verified_intervals;
     double const extra_verification_ratio;
     bool const without_cigar;
+    alignment::alignment_implementation const alignment_implementation = alignment::alignment_implementation::bit_parallel;
+    alignment::query_alignments& alignments;
+    statistics::search_and_alignment_statistics& stats;
+    // if not given, the patterns are computed for every alignment
+    query_profile const* const profile = nullptr;
+    bool const incremental_verification = false;
+};
+
+// verifies anchors that all belong to the same PEX leaf. For the hierarchical verification with the bit-parallel
+// implementation, the existence checks of the inner PEX nodes are collected level by level for all of the anchors
+// and run through the inter-sequence vectorized kernel. The results decide which of the anchors move on to
+// the next level. The roots are aligned one anchor at a time. Otherwise, the anchors are verified one by one.
+struct batched_query_verifier {
+    void verify();
+
+private:
+    query_verifier verifier_for(search::anchor_t const& anchor) const;
+
+public:
+    pex::pex_tree const& pex_tree;
+    std::span<const search::anchor_t> const anchors;
+    pex::pex_tree::node const& pex_leaf_node;
+    std::span<const uint8_t> const query;
+    alignment::query_orientation const orientation;
+    input::references const& references;
+    pex::verification_kind_t const kind;
+    intervals::verified_intervals_for_all_references& verified_intervals_for_all_references;
+    double const extra_verification_ratio;
+    bool const without_cigar;
+    alignment::alignment_implementation const alignment_implementation;
     alignment::query_alignments& alignments;
     statistics::search_and_alignment_statistics& stats;
+    query_profile const* const profile = nullptr;
+    bool const incremental_verification = false;
 };
 
 namespace internal {
 
+// during the hierarchical verification, the verified intervals are checked again only for larger reference spans
+static inline constexpr size_t max_reference_span_length_without_checking_intervals = 512;
+
 struct span_config {
     size_t const offset{};
     size_t const length{};
@@ -58,6 +139,34 @@ struct span_config {
     intervals::half_open_interval as_half_open_interval() const;
 };
 
+// an inner PEX node that was verified successfully during the incremental verification.
+// The positions of the end range are positions in the whole reference
+struct verified_child {
+    pex::pex_tree::node const pex_node;
+    bit_parallel_alignment::alignment_end_range const end_range;
+};
+
+// restricts the reference span of the parent of the verified child to the part in which an alignment of the parent
+// can exist that contains one of the alignments of the child. The extra verification length is kept on both sides.
+// The root is then only aligned in the narrowed span. Alignments of the query that don't contain an alignment of
+// the child are lost, so the reported root alignment can differ from the one of the verification without narrowing
+// if such an alignment is better than or as good as the ones in the narrowed span.
+span_config narrow_reference_span_to_verified_child(
+    span_config const reference_span_config,
+    pex::pex_tree::node const& pex_node,
+    verified_child const& child
+);
+
+// returns the end range of the alignments of the query span of an inner PEX node in positions of the whole reference
+std::optional<bit_parallel_alignment::alignment_end_range> compute_end_range_of_pex_node_query_in_reference_span(
+    pex::pex_tree::node const& pex_node,
+    input::reference_record const& reference,
+    span_config const reference_span_config,
+    std::span<const uint8_t> const query,
+    query_profile const* const profile,
+    statistics::search_and_alignment_statistics& stats
+);
+
 span_config compute_reference_span_start_and_length(
     search::anchor_t const& anchor,
     pex::pex_tree::node const& pex_node,
@@ -73,6 +182,8 @@ alignment::alignment_outcome try_to_align_pex_node_query_with_reference_span(
     std::span<const uint8_t> const query,
     alignment::query_orientation const orientation,
     bool const without_cigar,
+    alignment::alignment_implementation const alignment_implementation,
+    query_profile const* const profile,
     alignment::query_alignments& alignments,
     statistics::search_and_alignment_statistics& stats
 );
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <bit_parallel_alignment.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+// edit distance computation with wavefronts based on the WFA algorithm of Marco-Sola et al.
+// (DOI: https://doi.org/10.1093/bioinformatics/btaa777), restricted to unit costs.
+// For every score s (in increasing order) and every diagonal (reference position - query position),
+// the wavefront stores the furthest query position that can be reached with at most s errors. Runs of matches
+// are skipped by comparing the sequences along the diagonal. Hence, the running time is linear in the number of
+// diagonals times the actual number of errors of the best alignment instead of the allowed number of errors.
+// The alignments are semi-global like in bit_parallel_alignment and the results are identical to the ones of
+// the bit-parallel kernel, including the tie breaking.
+namespace wavefront_alignment {
+
+// like bit_parallel_alignment::best_alignment_end, but the query is not reversed by the caller.
+// If the direction is reverse, both the reference and the query are processed from back to front.
+// max_num_errors must be smaller than the query length.
+std::optional<bit_parallel_alignment::alignment_end> best_alignment_end(
+    std::span<const uint8_t> const reference,
+    std::span<const uint8_t> const query,
+    size_t const max_num_errors,
+    bit_parallel_alignment::sequence_direction const direction
+);
+
+// like bit_parallel_alignment::best_alignment_with_cigar. The traceback needs all wavefronts up to the
+// number of errors of the best alignment, so the memory usage grows with the number of errors times the number
+// of diagonals. Callers should limit max_num_errors, e.g. with max_num_errors_cheaper_than_bit_parallel.
+// max_num_errors must be smaller than the query length.
+std::optional<bit_parallel_alignment::alignment_with_cigar> best_alignment_with_cigar(
+    std::span<const uint8_t> const reference,
+    std::span<const uint8_t> const query,
+    size_t const max_num_errors
+);
+
+// the number of errors up to which computing the wavefronts is estimated to be cheaper than running the
+// bit-parallel kernel with max_num_errors (which has to compute the whole band).
+size_t max_num_errors_cheaper_than_bit_parallel(
+    size_t const reference_length,
+    size_t const query_length,
+    size_t const max_num_errors
+);
+
+} // namespace wavefront_alignment
@@ -1,10 +1,12 @@
 #include <alignment.hpp>
+#include <wavefront_alignment.hpp>
 
 #include <algorithm>
 #include <cassert>
 #include <charconv>
 #include <cmath>
 #include <limits>
+#include <stdexcept>
 #include <system_error>
 #include <utility>
 
@@ -78,6 +80,139 @@ void query_alignments::merge_other_into_this(query_alignments other) {
     }
 }
 
+size_t query_alignments::num_references() const {
+    return alignments_per_reference.size();
+}
+
+void collected_query_alignments::add(size_t const query_id, query_alignments alignments) {
+    if (alignments.size() == 0) {
+        return;
+    }
+
+    auto& collected = alignments_by_query_id[query_id];
+
+    for (size_t reference_id = 0; reference_id < alignments.num_references(); ++reference_id) {
+        for (auto& alignment : alignments.to_reference(reference_id)) {
+            collected.emplace_back(reference_id, std::move(alignment));
+        }
+    }
+}
+
+void collected_query_alignments::move_into(size_t const query_id, query_alignments& alignments) {
+    auto const iter = alignments_by_query_id.find(query_id);
+    if (iter == alignments_by_query_id.end()) {
+        return;
+    }
+
+    for (auto& [reference_id, alignment] : iter->second) {
+        alignments.insert(std::move(alignment), reference_id);
+    }
+
+    alignments_by_query_id.erase(iter);
+}
+
+size_t collected_query_alignments::num_queries() const {
+    return alignments_by_query_id.size();
+}
+
+void collected_query_alignments::add_milliseconds_spent_in_search(size_t const query_id, size_t const milliseconds) {
+    milliseconds_spent_in_search_by_query_id[query_id] += milliseconds;
+}
+
+void collected_query_alignments::add_milliseconds_spent_in_verification(
+    size_t const query_id,
+    size_t const milliseconds
+) {
+    milliseconds_spent_in_verification_by_query_id[query_id] += milliseconds;
+}
+
+static size_t take_milliseconds_of(
+    std::unordered_map<size_t, size_t>& milliseconds_by_query_id,
+    size_t const query_id
+) {
+    auto const iter = milliseconds_by_query_id.find(query_id);
+    if (iter == milliseconds_by_query_id.end()) {
+        return 0;
+    }
+
+    size_t const milliseconds = iter->second;
+    milliseconds_by_query_id.erase(iter);
+
+    return milliseconds;
+}
+
+size_t collected_query_alignments::take_milliseconds_spent_in_search(size_t const query_id) {
+    return take_milliseconds_of(milliseconds_spent_in_search_by_query_id, query_id);
+}
+
+size_t collected_query_alignments::take_milliseconds_spent_in_verification(size_t const query_id) {
+    return take_milliseconds_of(milliseconds_spent_in_verification_by_query_id, query_id);
+}
+
+alignment_implementation alignment_implementation_from_string(std::string_view const s) {
+    if (s == "bit_parallel") {
+        return alignment_implementation::bit_parallel;
+    } else if (s == "seqan3") {
+        return alignment_implementation::seqan3;
+    } else if (s == "wavefront") {
+        return alignment_implementation::wavefront;
+    } else if (s == "automatic") {
+        return alignment_implementation::automatic;
+    } else {
+        throw std::runtime_error("unexpected alignment implementation value");
+    }
+}
+
+bool uses_bit_parallel_kernel(alignment_implementation const implementation) {
+    return implementation == alignment_implementation::bit_parallel ||
+        implementation == alignment_implementation::automatic;
+}
+
+// returns std::nullopt if no alignment with at most max_num_errors errors exists.
+// max_num_errors must be smaller than the query length
+static std::optional<query_alignment> best_alignment_with_wavefronts(
+    std::span<const uint8_t> const reference,
+    std::span<const uint8_t> const query,
+    alignment_config const& config,
+    size_t const max_num_errors
+) {
+    if (config.mode == alignment_mode::verify_and_return_alignment_without_cigar) {
+        // like below, the begin position is computed as the end position of the reversed sequences
+        auto const best_end = wavefront_alignment::best_alignment_end(
+            reference,
+            query,
+            max_num_errors,
+            bit_parallel_alignment::sequence_direction::reverse
+        );
+
+        if (!best_end.has_value()) {
+            return std::nullopt;
+        }
+
+        return query_alignment {
+            .start_in_reference = config.reference_span_offset + reference.size() - best_end->end_position,
+            .num_errors = best_end->num_errors,
+            .orientation = config.orientation,
+            .cigar{}
+        };
+    }
+
+    assert(config.mode == alignment_mode::verify_and_return_alignment_with_cigar);
+
+    auto alignment = wavefront_alignment::best_alignment_with_cigar(reference, query, max_num_errors);
+
+    if (!alignment.has_value()) {
+        return std::nullopt;
+    }
+
+    return query_alignment {
+        .start_in_reference = config.reference_span_offset + alignment->start_position,
+        .num_errors = alignment->num_errors,
+        .orientation = config.orientation,
+        .cigar = std::move(alignment->cigar)
+    };
+}
+
 static constexpr uint64_t very_large_memory_usage = 10'000'000'000;
 
 alignment_result align(
@@ -85,6 +220,154 @@ alignment_result align(
     std::span<const uint8_t> const query,
     alignment_config const& config
 ) {
+    // the patterns are only computed if they are needed and were not precomputed
+    std::optional<bit_parallel_alignment::query_pattern> computed_pattern;
+    auto const pattern_of_query = [&] () -> bit_parallel_alignment::query_pattern const& {
+        return config.query_pattern != nullptr ? *config.query_pattern : computed_pattern.emplace(query);
+    };
+
+    std::optional<bit_parallel_alignment::query_pattern> computed_reverse_pattern;
+    auto const pattern_of_reverse_query = [&] () -> bit_parallel_alignment::query_pattern const& {
+        if (config.reverse_query_pattern != nullptr) {
+            return *config.reverse_query_pattern;
+        }
+
+        std::vector<uint8_t> const reverse_query(query.rbegin(), query.rend());
+        return computed_reverse_pattern.emplace(reverse_query);
+    };
+
+    if (
+        config.implementation == alignment_implementation::wavefront &&
+        config.mode == alignment_mode::only_verify_existance &&
+        config.num_allowed_errors < query.size()
+    ) {
+        bool const exists = wavefront_alignment::best_alignment_end(
+            reference,
+            query,
+            config.num_allowed_errors,
+            bit_parallel_alignment::sequence_direction::forward
+        ).has_value();
+
+        return alignment_result {
+            .outcome = exists ?
+                alignment_outcome::alignment_exists :
+                alignment_outcome::no_adequate_alignment_exists
+        };
+    }
+
+    if (
+        (
+            config.implementation == alignment_implementation::wavefront ||
+            config.implementation == alignment_implementation::automatic
+        ) &&
+        config.mode != alignment_mode::only_verify_existance &&
+        config.num_allowed_errors < query.size()
+    ) {
+        // The traceback needs all wavefronts, so it is only used up to the number of errors for which the
+        // wavefronts are cheaper than the bit-parallel kernel, also by the wavefront implementation.
+        // This keeps the number of stored wavefront cells at about half of the number of blocks computed by the kernel
+        bool const only_best_end = config.implementation == alignment_implementation::wavefront &&
+            config.mode == alignment_mode::verify_and_return_alignment_without_cigar;
+        size_t const max_num_errors = only_best_end ?
+            config.num_allowed_errors :
+            wavefront_alignment::max_num_errors_cheaper_than_bit_parallel(
+                reference.size(),
+                query.size(),
+                config.num_allowed_errors
+            );
+
+        auto alignment = best_alignment_with_wavefronts(reference, query, config, max_num_errors);
+
+        if (alignment.has_value()) {
+            return alignment_result {
+                .outcome = alignment_outcome::alignment_exists,
+                .alignment = std::move(alignment)
+            };
+        }
+
+        if (max_num_errors == config.num_allowed_errors) {
+            return alignment_result { .outcome = alignment_outcome::no_adequate_alignment_exists };
+        }
+
+        // the best alignment has more errors, for which the bit-parallel kernel below is faster
+    }
+
+    if (
+        uses_bit_parallel_kernel(config.implementation) &&
+        config.mode == alignment_mode::only_verify_existance
+    ) {
+        bool const exists = bit_parallel_alignment::alignment_exists(
+            reference,
+            pattern_of_query(),
+            config.num_allowed_errors
+        );
+
+        return alignment_result {
+            .outcome = exists ?
+                alignment_outcome::alignment_exists :
+                alignment_outcome::no_adequate_alignment_exists
+        };
+    }
+
+    if (
+        uses_bit_parallel_kernel(config.implementation) &&
+        config.mode == alignment_mode::verify_and_return_alignment_without_cigar &&
+        config.num_allowed_errors < query.size()
+    ) {
+        // like below, the begin position is computed as the end position of the reversed sequences
+        auto const best_end = bit_parallel_alignment::best_alignment_end(
+            reference,
+            pattern_of_reverse_query(),
+            config.num_allowed_errors,
+            bit_parallel_alignment::sequence_direction::reverse
+        );
+
+        if (!best_end.has_value()) {
+            return alignment_result { .outcome = alignment_outcome::no_adequate_alignment_exists };
+        }
+
+        return alignment_result {
+            .outcome = alignment_outcome::alignment_exists,
+            .alignment = query_alignment {
+                .start_in_reference = config.reference_span_offset + reference.size() - best_end->end_position,
+                .num_errors = best_end->num_errors,
+                .orientation = config.orientation,
+                .cigar{}
+            }
+        };
+    }
+
+    if (
+        (
+            uses_bit_parallel_kernel(config.implementation) ||
+            config.implementation == alignment_implementation::wavefront
+        ) &&
+        config.mode == alignment_mode::verify_and_return_alignment_with_cigar &&
+        config.num_allowed_errors < query.size()
+    ) {
+        // the score-only passes pin the alignment to a tight window, in which the traceback is cheap
+        auto alignment = bit_parallel_alignment::best_alignment_with_cigar(
+            reference,
+            pattern_of_query(),
+            pattern_of_reverse_query(),
+            config.num_allowed_errors
+        );
+
+        if (!alignment.has_value()) {
+            return alignment_result { .outcome = alignment_outcome::no_adequate_alignment_exists };
+        }
+
+        return alignment_result {
+            .outcome = alignment_outcome::alignment_exists,
+            .alignment = query_alignment {
+                .start_in_reference = config.reference_span_offset + alignment->start_position,
+                .num_errors = alignment->num_errors,
+                .orientation = config.orientation,
+                .cigar = std::move(alignment->cigar)
+            }
+        };
+    }
+
     int32_t const min_score = -static_cast<int>(config.num_allowed_errors);
     auto aligner_config = seqan3::align_cfg::method_global{
         seqan3::align_cfg::free_end_gaps_sequence1_leading{true},
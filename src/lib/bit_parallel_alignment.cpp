@@ -0,0 +1,933 @@
+#include <bit_parallel_alignment.hpp>
+#include <math.hpp>
+#include <multiversioning.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace bit_parallel_alignment {
+
+query_pattern::query_pattern(std::span<const uint8_t> const query)
+    : length_{query.size()},
+    num_blocks_{math::ceil_div(query.size(), word_size)},
+    masks(num_blocks_ * rank_alphabet_size, 0) {
+    for (size_t i = 0; i < query.size(); ++i) {
+        if (query[i] < rank_alphabet_size) {
+            masks[(i / word_size) * rank_alphabet_size + query[i]] |= uint64_t{1} << (i % word_size);
+        }
+    }
+}
+
+size_t query_pattern::length() const {
+    return length_;
+}
+
+size_t query_pattern::num_blocks() const {
+    return num_blocks_;
+}
+
+namespace internal {
+
+size_t score_bit_of(query_pattern const& pattern, size_t const block_index) {
+    return block_index == pattern.num_blocks() - 1 ? (pattern.length() - 1) % word_size : word_size - 1;
+}
+
+static size_t num_rows_of(query_pattern const& pattern, size_t const block_index) {
+    return score_bit_of(pattern, block_index) + 1;
+}
+
+// Only the blocks that intersect the diagonal band of the reference span are computed.
+// Blocks below the band are cut off when all of their cells have a too high score (Ukkonen's cut-off).
+// Blocks above the band are dropped when none of their cells can be part of an alignment that
+// ends inside of the reference with at most max_num_errors errors.
+template<size_t static_num_blocks>
+banded_columns<static_num_blocks>::banded_columns(
+    query_pattern const& pattern_,
+    size_t const max_num_errors_,
+    size_t const reference_length
+) : pattern{pattern_},
+    max_num_errors{max_num_errors_},
+    // a cell in row i and column j can only be part of an alignment with at most max_num_errors that
+    // ends inside of the reference, if j - i <= reference.size() - query.size() + max_num_errors
+    max_diagonal{
+        static_cast<int64_t>(reference_length) -
+        static_cast<int64_t>(pattern_.length()) +
+        static_cast<int64_t>(max_num_errors_)
+    },
+    column_{0},
+    active_blocks_begin_{0},
+    // in the first column, the score of every cell is its row index. Only the blocks that
+    // contain cells with a score of at most max_num_errors are active
+    active_blocks_end_{std::min(pattern_.num_blocks(), max_num_errors_ / word_size + 1)},
+    blocks{}
+{
+    assert(max_num_errors < pattern.length());
+    assert(static_num_blocks == dynamic_num_blocks || static_num_blocks == pattern.num_blocks());
+
+    if constexpr (static_num_blocks == dynamic_num_blocks) {
+        blocks.resize(pattern.num_blocks());
+    }
+
+    for (size_t block_index = 0; block_index < active_blocks_end_; ++block_index) {
+        blocks[block_index] = block {
+            .positive_vertical = ~uint64_t{0},
+            .negative_vertical = 0,
+            .score = block_index * word_size + num_rows_of(pattern, block_index)
+        };
+    }
+}
+
+template<size_t static_num_blocks>
+bool banded_columns<static_num_blocks>::advance(uint8_t const rank) {
+    ++column_;
+
+    while (
+        active_blocks_begin_ < active_blocks_end_ &&
+        static_cast<int64_t>(column_) - static_cast<int64_t>((active_blocks_begin_ + 1) * word_size) > max_diagonal
+    ) {
+        ++active_blocks_begin_;
+    }
+
+    if (active_blocks_begin_ == active_blocks_end_) {
+        return false;
+    }
+
+    // the first row has score 0 everywhere, because of the free leading gaps in the reference.
+    // For a dropped first row, we overestimate the scores by assuming that every column adds one error.
+    int horizontal_input = active_blocks_begin_ == 0 ? 0 : 1;
+    size_t previous_score_of_last_active_block = 0;
+
+    for (size_t block_index = active_blocks_begin_; block_index < active_blocks_end_; ++block_index) {
+        auto& b = blocks[block_index];
+        previous_score_of_last_active_block = b.score;
+
+        auto const deltas = advance_block(b, pattern.match_mask(block_index, rank), horizontal_input);
+        b.score += deltas.delta_at(score_bit_of(pattern, block_index));
+        horizontal_input = deltas.delta_at(word_size - 1);
+    }
+
+    // with a single block, the only block is active until the end of the band is reached
+    if constexpr (static_num_blocks != 1) {
+        // activate the next block if its first row could be reached with at most max_num_errors errors,
+        // either diagonally from the previous column or vertically from the current column
+        while (
+            active_blocks_end_ < num_blocks() &&
+            std::min(previous_score_of_last_active_block, blocks[active_blocks_end_ - 1].score) <= max_num_errors
+        ) {
+            auto& b = blocks[active_blocks_end_];
+
+            // without knowledge about the previous column, we assume that every row adds one error
+            previous_score_of_last_active_block += num_rows_of(pattern, active_blocks_end_);
+            b = block {
+                .positive_vertical = ~uint64_t{0},
+                .negative_vertical = 0,
+                .score = previous_score_of_last_active_block
+            };
+
+            auto const deltas = advance_block(b, pattern.match_mask(active_blocks_end_, rank), horizontal_input);
+            b.score += deltas.delta_at(score_bit_of(pattern, active_blocks_end_));
+            horizontal_input = deltas.delta_at(word_size - 1);
+
+            ++active_blocks_end_;
+        }
+
+        // deactivate blocks at the bottom where every cell has a score larger than max_num_errors, unless the block
+        // above would activate it again in the next column. Then it has to stay active, because the block above
+        // might be dropped by the band before it can activate the block
+        while (
+            active_blocks_end_ > active_blocks_begin_ + 1 &&
+            blocks[active_blocks_end_ - 1].score >= max_num_errors + num_rows_of(pattern, active_blocks_end_ - 1) &&
+            blocks[active_blocks_end_ - 2].score > max_num_errors
+        ) {
+            --active_blocks_end_;
+        }
+    }
+
+    return true;
+}
+
+template<size_t static_num_blocks>
+size_t banded_columns<static_num_blocks>::column() const {
+    return column_;
+}
+
+template<size_t static_num_blocks>
+std::optional<size_t> banded_columns<static_num_blocks>::last_row_score() const {
+    if (active_blocks_end_ == num_blocks() && blocks.back().score <= max_num_errors) {
+        return blocks.back().score;
+    }
+
+    return std::nullopt;
+}
+
+template<size_t static_num_blocks>
+size_t banded_columns<static_num_blocks>::active_blocks_begin() const {
+    return active_blocks_begin_;
+}
+
+template<size_t static_num_blocks>
+std::span<const block> banded_columns<static_num_blocks>::active_blocks() const {
+    return std::span<const block>(blocks).subspan(active_blocks_begin_, active_blocks_end_ - active_blocks_begin_);
+}
+
+template<size_t static_num_blocks>
+void banded_columns<static_num_blocks>::restore(
+    size_t const column,
+    size_t const active_blocks_begin,
+    std::span<const block> const active_blocks
+) {
+    column_ = column;
+    active_blocks_begin_ = active_blocks_begin;
+    active_blocks_end_ = active_blocks_begin + active_blocks.size();
+    std::ranges::copy(active_blocks, blocks.begin() + active_blocks_begin);
+}
+
+template<size_t static_num_blocks>
+size_t banded_columns<static_num_blocks>::num_blocks() const {
+    if constexpr (static_num_blocks == dynamic_num_blocks) {
+        return pattern.num_blocks();
+    } else {
+        return static_num_blocks;
+    }
+}
+
+template class banded_columns<dynamic_num_blocks>;
+template class banded_columns<1>;
+template class banded_columns<2>;
+template class banded_columns<3>;
+template class banded_columns<4>;
+
+static_assert(max_static_num_blocks == 4, "banded_columns has to be instantiated for every static number of blocks");
+
+// calls f with std::integral_constant<size_t, static_num_blocks> for the kernel specialization
+// that fits the number of blocks of the pattern
+template<typename F>
+decltype(auto) with_static_num_blocks(query_pattern const& pattern, F&& f) {
+    switch (pattern.num_blocks()) {
+        case 1:
+            return f(std::integral_constant<size_t, 1>{});
+        case 2:
+            return f(std::integral_constant<size_t, 2>{});
+        case 3:
+            return f(std::integral_constant<size_t, 3>{});
+        case 4:
+            return f(std::integral_constant<size_t, 4>{});
+        default:
+            return f(std::integral_constant<size_t, dynamic_num_blocks>{});
+    }
+}
+
+static constexpr size_t outside_of_band_score = std::numeric_limits<size_t>::max() / 2;
+
+size_t score_in_column(
+    query_pattern const& pattern,
+    size_t const active_blocks_begin,
+    std::span<const block> const active_blocks,
+    size_t const row
+) {
+    // the first row has score 0 everywhere, because of the free leading gaps in the reference
+    if (row == 0) {
+        return 0;
+    }
+
+    size_t const block_index = (row - 1) / word_size;
+    if (block_index < active_blocks_begin || block_index >= active_blocks_begin + active_blocks.size()) {
+        return outside_of_band_score;
+    }
+
+    auto const& b = active_blocks[block_index - active_blocks_begin];
+    size_t const bit = (row - 1) % word_size;
+    size_t const score_bit = score_bit_of(pattern, block_index);
+
+    // the vertical deltas between this row and the row where the score of the block is stored
+    uint64_t const rows_below_mask = ((uint64_t{2} << score_bit) - 1) ^ ((uint64_t{2} << bit) - 1);
+
+    return b.score -
+        std::popcount(b.positive_vertical & rows_below_mask) +
+        std::popcount(b.negative_vertical & rows_below_mask);
+}
+
+// Computes the columns of the DP matrix and calls on_last_row_score(column, score) for every
+// column where the score in the last row is at most max_num_errors. Columns are 1-based,
+// the last row score of column j belongs to an alignment that ends before reference position j.
+// Stops early if on_last_row_score returns true.
+template<size_t static_num_blocks, typename F>
+FLOXER_MULTIVERSIONED
+void compute_last_row_scores_with_static_num_blocks(
+    std::span<const uint8_t> const reference,
+    query_pattern const& pattern,
+    size_t const max_num_errors,
+    sequence_direction const direction,
+    F&& on_last_row_score
+) {
+    banded_columns<static_num_blocks> columns(pattern, max_num_errors, reference.size());
+
+    for (size_t column = 1; column <= reference.size(); ++column) {
+        uint8_t const rank = direction == sequence_direction::forward ?
+            reference[column - 1] :
+            reference[reference.size() - column];
+
+        if (!columns.advance(rank)) {
+            return;
+        }
+
+        auto const score = columns.last_row_score();
+        if (score.has_value() && on_last_row_score(column, *score)) {
+            return;
+        }
+    }
+}
+
+template<typename F>
+void compute_last_row_scores(
+    std::span<const uint8_t> const reference,
+    query_pattern const& pattern,
+    size_t const max_num_errors,
+    sequence_direction const direction,
+    F&& on_last_row_score
+) {
+    with_static_num_blocks(pattern, [&] (auto const static_num_blocks) {
+        compute_last_row_scores_with_static_num_blocks<decltype(static_num_blocks)::value>(
+            reference,
+            pattern,
+            max_num_errors,
+            direction,
+            on_last_row_score
+        );
+    });
+}
+
+// the active blocks of a number of consecutive columns
+class stored_columns {
+public:
+    void clear() {
+        first_column = 0;
+        active_blocks_begins.clear();
+        offsets.clear();
+        blocks.clear();
+    }
+
+    void set_first_column(size_t const column) {
+        first_column = column;
+    }
+
+    void store(size_t const active_blocks_begin, std::span<const block> const active_blocks) {
+        active_blocks_begins.push_back(active_blocks_begin);
+        offsets.push_back(blocks.size());
+        blocks.insert(blocks.end(), active_blocks.begin(), active_blocks.end());
+    }
+
+    size_t num_columns() const {
+        return offsets.size();
+    }
+
+    size_t column_of(size_t const index) const {
+        return first_column + index;
+    }
+
+    size_t active_blocks_begin_of(size_t const index) const {
+        return active_blocks_begins[index];
+    }
+
+    std::span<const block> active_blocks_of(size_t const index) const {
+        size_t const end = index + 1 < offsets.size() ? offsets[index + 1] : blocks.size();
+        return std::span(blocks).subspan(offsets[index], end - offsets[index]);
+    }
+
+    size_t score(query_pattern const& pattern, size_t const column, size_t const row) const {
+        size_t const index = column - first_column;
+        return score_in_column(pattern, active_blocks_begin_of(index), active_blocks_of(index), row);
+    }
+
+private:
+    size_t first_column;
+    std::vector<size_t> active_blocks_begins;
+    std::vector<size_t> offsets;
+    std::vector<block> blocks;
+};
+
+// the vector types of the inter-sequence vectorized kernel, based on the GCC/Clang vector extensions.
+// Every 64 bit lane holds the state of a different reference. The alignment is given explicitly, because
+// the natural alignment of the vector types depends on the instruction set the code is compiled for and
+// the multiversioned kernels have to agree with the allocations of the baseline code.
+static constexpr size_t lanes_alignment = num_lanes * sizeof(uint64_t);
+typedef uint64_t lanes_t __attribute__((vector_size(num_lanes * sizeof(uint64_t)), aligned(lanes_alignment)));
+typedef int64_t signed_lanes_t __attribute__((vector_size(num_lanes * sizeof(int64_t)), aligned(lanes_alignment)));
+
+struct block_lanes {
+    lanes_t positive_vertical;
+    lanes_t negative_vertical;
+    signed_lanes_t score;
+};
+
+// the score delta of the row above a block, every lane is either 0 or 1
+struct horizontal_lanes {
+    lanes_t positive;
+    lanes_t negative;
+};
+
+// like advance_block, but also updates the score and returns the horizontal input for the next block
+static horizontal_lanes advance_block_lanes(
+    block_lanes& b,
+    lanes_t const& query_match_mask,
+    horizontal_lanes const& horizontal_input,
+    size_t const score_bit
+) {
+    lanes_t const positive_vertical = b.positive_vertical;
+    lanes_t const negative_vertical = b.negative_vertical;
+
+    lanes_t const vertical_x = query_match_mask | negative_vertical;
+    lanes_t const match_mask = query_match_mask | horizontal_input.negative;
+    lanes_t const horizontal_x = (((match_mask & positive_vertical) + positive_vertical) ^ positive_vertical)
+        | match_mask;
+
+    lanes_t positive_horizontal = negative_vertical | ~(horizontal_x | positive_vertical);
+    lanes_t negative_horizontal = positive_vertical & horizontal_x;
+
+    b.score += __builtin_convertvector((positive_horizontal >> score_bit) & 1, signed_lanes_t) -
+        __builtin_convertvector((negative_horizontal >> score_bit) & 1, signed_lanes_t);
+
+    horizontal_lanes const horizontal_output {
+        .positive = (positive_horizontal >> (word_size - 1)) & 1,
+        .negative = (negative_horizontal >> (word_size - 1)) & 1
+    };
+
+    positive_horizontal = (positive_horizontal << 1) | horizontal_input.positive;
+    negative_horizontal = (negative_horizontal << 1) | horizontal_input.negative;
+
+    b.positive_vertical = negative_horizontal | ~(vertical_x | positive_horizontal);
+    b.negative_vertical = positive_horizontal & vertical_x;
+
+    return horizontal_output;
+}
+
+static void add_to_end_range(
+    std::optional<alignment_end_range>& end_range,
+    size_t const column,
+    size_t const score
+) {
+    size_t const end_position_minus_num_errors = column >= score ? column - score : 0;
+
+    if (!end_range.has_value()) {
+        end_range = alignment_end_range {
+            .min_end_position = column,
+            .max_end_position_minus_num_errors = end_position_minus_num_errors
+        };
+    } else {
+        end_range->min_end_position = std::min(end_range->min_end_position, column);
+        end_range->max_end_position_minus_num_errors = std::max(
+            end_range->max_end_position_minus_num_errors,
+            end_position_minus_num_errors
+        );
+    }
+}
+
+// the same banded computation as banded_columns, for up to num_lanes references at once.
+// A block is active if it is needed by any of the lanes and the band is determined by the longest reference.
+// If stop_at_first_end is true, the end ranges only contain the first end of every lane.
+template<size_t static_num_blocks>
+FLOXER_MULTIVERSIONED
+static std::array<std::optional<alignment_end_range>, num_lanes> end_ranges_in_lanes_with_static_num_blocks(
+    std::span<const std::span<const uint8_t>> const references,
+    query_pattern const& pattern,
+    size_t const max_num_errors,
+    bool const stop_at_first_end
+) {
+    assert(references.size() <= num_lanes);
+    assert(max_num_errors < pattern.length());
+    assert(static_num_blocks == dynamic_num_blocks || static_num_blocks == pattern.num_blocks());
+
+    size_t const num_blocks = static_num_blocks == dynamic_num_blocks ? pattern.num_blocks() : static_num_blocks;
+    size_t max_reference_length = 0;
+    for (auto const& reference : references) {
+        max_reference_length = std::max(max_reference_length, reference.size());
+    }
+
+    int64_t const max_diagonal = static_cast<int64_t>(max_reference_length) -
+        static_cast<int64_t>(pattern.length()) +
+        static_cast<int64_t>(max_num_errors);
+    int64_t const max_score = static_cast<int64_t>(max_num_errors);
+
+    std::conditional_t<
+        static_num_blocks == dynamic_num_blocks,
+        std::vector<block_lanes>,
+        std::array<block_lanes, static_num_blocks>
+    > blocks{};
+    if constexpr (static_num_blocks == dynamic_num_blocks) {
+        blocks.resize(num_blocks);
+    }
+
+    size_t active_blocks_begin = 0;
+    size_t active_blocks_end = std::min(num_blocks, max_num_errors / word_size + 1);
+    for (size_t block_index = 0; block_index < active_blocks_end; ++block_index) {
+        blocks[block_index] = block_lanes {
+            .positive_vertical = ~lanes_t{},
+            .negative_vertical = lanes_t{},
+            .score = signed_lanes_t{} + static_cast<int64_t>(block_index * word_size + num_rows_of(pattern, block_index))
+        };
+    }
+
+    std::array<std::optional<alignment_end_range>, num_lanes> end_ranges{};
+    size_t num_lanes_with_end = 0;
+
+    std::array<uint8_t, num_lanes> ranks{};
+    lanes_t match_mask{};
+    auto const load_match_mask = [&pattern, &ranks, &match_mask] (size_t const block_index) {
+        for (size_t lane = 0; lane < num_lanes; ++lane) {
+            match_mask[lane] = pattern.match_mask(block_index, ranks[lane]);
+        }
+    };
+
+    for (size_t column = 1; column <= max_reference_length; ++column) {
+        while (
+            active_blocks_begin < active_blocks_end &&
+            static_cast<int64_t>(column) - static_cast<int64_t>((active_blocks_begin + 1) * word_size) > max_diagonal
+        ) {
+            ++active_blocks_begin;
+        }
+
+        if (active_blocks_begin == active_blocks_end) {
+            break;
+        }
+
+        // lanes whose reference has already ended get a rank that never matches
+        for (size_t lane = 0; lane < num_lanes; ++lane) {
+            ranks[lane] = lane < references.size() && column <= references[lane].size() ?
+                references[lane][column - 1] :
+                rank_alphabet_size;
+        }
+
+        horizontal_lanes horizontal_input {
+            .positive = active_blocks_begin == 0 ? lanes_t{} : lanes_t{} + 1,
+            .negative = lanes_t{}
+        };
+        signed_lanes_t previous_score_of_last_active_block{};
+
+        for (size_t block_index = active_blocks_begin; block_index < active_blocks_end; ++block_index) {
+            previous_score_of_last_active_block = blocks[block_index].score;
+            load_match_mask(block_index);
+            horizontal_input = advance_block_lanes(
+                blocks[block_index],
+                match_mask,
+                horizontal_input,
+                score_bit_of(pattern, block_index)
+            );
+        }
+
+        // like in banded_columns::advance
+        if constexpr (static_num_blocks != 1) {
+            auto const any_lane_needs_next_block = [&] () {
+                signed_lanes_t const last_active_score = blocks[active_blocks_end - 1].score;
+                for (size_t lane = 0; lane < num_lanes; ++lane) {
+                    if (std::min(previous_score_of_last_active_block[lane], last_active_score[lane]) <= max_score) {
+                        return true;
+                    }
+                }
+                return false;
+            };
+
+            while (active_blocks_end < num_blocks && any_lane_needs_next_block()) {
+                previous_score_of_last_active_block += static_cast<int64_t>(num_rows_of(pattern, active_blocks_end));
+                blocks[active_blocks_end] = block_lanes {
+                    .positive_vertical = ~lanes_t{},
+                    .negative_vertical = lanes_t{},
+                    .score = previous_score_of_last_active_block
+                };
+
+                load_match_mask(active_blocks_end);
+                horizontal_input = advance_block_lanes(
+                    blocks[active_blocks_end],
+                    match_mask,
+                    horizontal_input,
+                    score_bit_of(pattern, active_blocks_end)
+                );
+
+                ++active_blocks_end;
+            }
+
+            auto const all_lanes_can_drop_last_block = [&] () {
+                int64_t const min_score = max_score + static_cast<int64_t>(num_rows_of(pattern, active_blocks_end - 1));
+                signed_lanes_t const last_active_score = blocks[active_blocks_end - 1].score;
+                signed_lanes_t const score_above = blocks[active_blocks_end - 2].score;
+                for (size_t lane = 0; lane < num_lanes; ++lane) {
+                    if (last_active_score[lane] < min_score || score_above[lane] <= max_score) {
+                        return false;
+                    }
+                }
+                return true;
+            };
+
+            while (active_blocks_end > active_blocks_begin + 1 && all_lanes_can_drop_last_block()) {
+                --active_blocks_end;
+            }
+        }
+
+        if (active_blocks_end == num_blocks) {
+            signed_lanes_t const last_row_score = blocks.back().score;
+            for (size_t lane = 0; lane < references.size(); ++lane) {
+                if (column <= references[lane].size() && last_row_score[lane] <= max_score) {
+                    num_lanes_with_end += !end_ranges[lane].has_value();
+                    add_to_end_range(end_ranges[lane], column, static_cast<size_t>(last_row_score[lane]));
+                }
+            }
+
+            if (stop_at_first_end && num_lanes_with_end == references.size()) {
+                break;
+            }
+        }
+    }
+
+    return end_ranges;
+}
+
+static std::array<std::optional<alignment_end_range>, num_lanes> end_ranges_in_lanes(
+    std::span<const std::span<const uint8_t>> const references,
+    query_pattern const& pattern,
+    size_t const max_num_errors,
+    bool const stop_at_first_end
+) {
+    return with_static_num_blocks(pattern, [&] (auto const static_num_blocks) {
+        return end_ranges_in_lanes_with_static_num_blocks<decltype(static_num_blocks)::value>(
+            references,
+            pattern,
+            max_num_errors,
+            stop_at_first_end
+        );
+    });
+}
+
+std::vector<seqan3::cigar> run_length_encode(std::vector<char> const& reverse_operations) {
+    std::vector<seqan3::cigar> cigar{};
+
+    for (auto iter = reverse_operations.rbegin(); iter != reverse_operations.rend();) {
+        char const operation = *iter;
+        uint32_t count = 0;
+
+        while (iter != reverse_operations.rend() && *iter == operation) {
+            ++count;
+            ++iter;
+        }
+
+        cigar.emplace_back(count, seqan3::cigar::operation{}.assign_char(operation));
+    }
+
+    return cigar;
+}
+
+template<size_t static_num_blocks>
+FLOXER_MULTIVERSIONED
+static std::optional<alignment_with_cigar> best_alignment_with_cigar_with_static_num_blocks(
+    std::span<const uint8_t> const reference,
+    query_pattern const& pattern,
+    size_t const max_num_errors
+) {
+    assert(max_num_errors < pattern.length());
+
+    size_t const checkpoint_distance = std::max(
+        size_t{1},
+        static_cast<size_t>(std::sqrt(static_cast<double>(reference.size())))
+    );
+
+    // first pass: find the best alignment end and store the state of every checkpoint_distance-th column
+    banded_columns<static_num_blocks> columns(pattern, max_num_errors, reference.size());
+    stored_columns checkpoints{};
+    std::vector<size_t> checkpoint_columns{};
+
+    auto const store_checkpoint = [&columns, &checkpoints, &checkpoint_columns] () {
+        checkpoints.store(columns.active_blocks_begin(), columns.active_blocks());
+        checkpoint_columns.push_back(columns.column());
+    };
+
+    store_checkpoint();
+
+    std::optional<alignment_end> best_end = std::nullopt;
+
+    for (size_t column = 1; column <= reference.size(); ++column) {
+        if (!columns.advance(reference[column - 1])) {
+            break;
+        }
+
+        auto const score = columns.last_row_score();
+        if (score.has_value() && (!best_end.has_value() || *score <= best_end->num_errors)) {
+            best_end = alignment_end { .num_errors = *score, .end_position = column };
+        }
+
+        if (column % checkpoint_distance == 0) {
+            store_checkpoint();
+        }
+    }
+
+    if (!best_end.has_value()) {
+        return std::nullopt;
+    }
+
+    // second pass: traceback from the best end, segment by segment from back to front.
+    // Every segment is recomputed from its checkpoint and stores all of its columns.
+    std::vector<char> reverse_operations{};
+    reverse_operations.reserve(pattern.length() + max_num_errors);
+
+    size_t row = pattern.length();
+    size_t column = best_end->end_position;
+    size_t score = best_end->num_errors;
+
+    stored_columns segment{};
+    size_t checkpoint_index = checkpoint_columns.size() - 1;
+
+    while (row > 0 && column > 0) {
+        // find the checkpoint with the largest column smaller than the current column
+        while (checkpoint_columns[checkpoint_index] >= column) {
+            --checkpoint_index;
+        }
+
+        size_t const segment_begin_column = checkpoint_columns[checkpoint_index];
+
+        columns.restore(
+            segment_begin_column,
+            checkpoints.active_blocks_begin_of(checkpoint_index),
+            checkpoints.active_blocks_of(checkpoint_index)
+        );
+
+        segment.clear();
+        segment.set_first_column(segment_begin_column);
+        segment.store(columns.active_blocks_begin(), columns.active_blocks());
+
+        while (columns.column() < column) {
+            columns.advance(reference[columns.column()]);
+            segment.store(columns.active_blocks_begin(), columns.active_blocks());
+        }
+
+        while (row > 0 && column > segment_begin_column) {
+            bool const is_match = (pattern.match_mask((row - 1) / word_size, reference[column - 1])
+                >> ((row - 1) % word_size)) & 1;
+
+            size_t const diagonal_score = segment.score(pattern, column - 1, row - 1) + (is_match ? 0 : 1);
+            size_t const up_score = segment.score(pattern, column, row - 1) + 1;
+            size_t const left_score = segment.score(pattern, column - 1, row) + 1;
+
+            if (diagonal_score == score) {
+                reverse_operations.push_back(is_match ? '=' : 'X');
+                score = diagonal_score - (is_match ? 0 : 1);
+                --row;
+                --column;
+            } else if (up_score == score) {
+                reverse_operations.push_back('I');
+                score = up_score - 1;
+                --row;
+            } else {
+                assert(left_score == score);
+                reverse_operations.push_back('D');
+                score = left_score - 1;
+                --column;
+            }
+        }
+    }
+
+    // the remaining query characters at the very beginning of the reference are insertions
+    reverse_operations.insert(reverse_operations.end(), row, 'I');
+
+    return alignment_with_cigar {
+        .num_errors = best_end->num_errors,
+        .start_position = column,
+        .cigar = run_length_encode(reverse_operations)
+    };
+}
+
+} // namespace internal
+
+bool alignment_exists(
+    std::span<const uint8_t> const reference,
+    query_pattern const& pattern,
+    size_t const max_num_errors
+) {
+    // the whole query can always be aligned using only insertions
+    if (max_num_errors >= pattern.length()) {
+        return true;
+    }
+
+    bool exists = false;
+
+    internal::compute_last_row_scores(
+        reference,
+        pattern,
+        max_num_errors,
+        sequence_direction::forward,
+        [&exists] ([[maybe_unused]] size_t const column, [[maybe_unused]] size_t const score) {
+            exists = true;
+            return true;
+        }
+    );
+
+    return exists;
+}
+
+std::vector<bool> alignments_exist(
+    std::span<const std::span<const uint8_t>> const references,
+    query_pattern const& pattern,
+    size_t const max_num_errors
+) {
+    // the whole query can always be aligned using only insertions
+    if (max_num_errors >= pattern.length()) {
+        return std::vector<bool>(references.size(), true);
+    }
+
+    std::vector<bool> exists(references.size());
+
+    for (size_t group_begin = 0; group_begin < references.size(); group_begin += num_lanes) {
+        auto const group = references.subspan(group_begin, std::min(num_lanes, references.size() - group_begin));
+        auto const end_ranges_of_group = internal::end_ranges_in_lanes(group, pattern, max_num_errors, true);
+
+        for (size_t lane = 0; lane < group.size(); ++lane) {
+            exists[group_begin + lane] = end_ranges_of_group[lane].has_value();
+        }
+    }
+
+    return exists;
+}
+
+std::optional<alignment_end_range> alignment_end_range_of(
+    std::span<const uint8_t> const reference,
+    query_pattern const& pattern,
+    size_t const max_num_errors
+) {
+    // the query can end anywhere using only insertions, this is not worth computing exactly
+    if (max_num_errors >= pattern.length()) {
+        return alignment_end_range {
+            .min_end_position = 0,
+            .max_end_position_minus_num_errors = reference.size()
+        };
+    }
+
+    std::optional<alignment_end_range> end_range = std::nullopt;
+
+    internal::compute_last_row_scores(
+        reference,
+        pattern,
+        max_num_errors,
+        sequence_direction::forward,
+        [&end_range] (size_t const column, size_t const score) {
+            internal::add_to_end_range(end_range, column, score);
+            return false;
+        }
+    );
+
+    return end_range;
+}
+
+std::vector<std::optional<alignment_end_range>> alignment_end_ranges(
+    std::span<const std::span<const uint8_t>> const references,
+    query_pattern const& pattern,
+    size_t const max_num_errors
+) {
+    std::vector<std::optional<alignment_end_range>> end_ranges(references.size());
+
+    if (max_num_errors >= pattern.length()) {
+        for (size_t i = 0; i < references.size(); ++i) {
+            end_ranges[i] = alignment_end_range_of(references[i], pattern, max_num_errors);
+        }
+
+        return end_ranges;
+    }
+
+    for (size_t group_begin = 0; group_begin < references.size(); group_begin += num_lanes) {
+        auto const group = references.subspan(group_begin, std::min(num_lanes, references.size() - group_begin));
+        auto const end_ranges_of_group = internal::end_ranges_in_lanes(group, pattern, max_num_errors, false);
+
+        std::ranges::copy(
+            std::span(end_ranges_of_group).first(group.size()),
+            end_ranges.begin() + group_begin
+        );
+    }
+
+    return end_ranges;
+}
+
+std::optional<alignment_end> best_alignment_end(
+    std::span<const uint8_t> const reference,
+    query_pattern const& pattern,
+    size_t const max_num_errors,
+    sequence_direction const direction
+) {
+    assert(max_num_errors < pattern.length());
+
+    std::optional<alignment_end> best_end = std::nullopt;
+
+    internal::compute_last_row_scores(
+        reference,
+        pattern,
+        max_num_errors,
+        direction,
+        [&best_end] (size_t const column, size_t const score) {
+            if (!best_end.has_value() || score <= best_end->num_errors) {
+                best_end = alignment_end {
+                    .num_errors = score,
+                    .end_position = column
+                };
+            }
+
+            return false;
+        }
+    );
+
+    return best_end;
+}
+
+std::optional<alignment_with_cigar> best_alignment_with_cigar(
+    std::span<const uint8_t> const reference,
+    query_pattern const& pattern,
+    size_t const max_num_errors
+) {
+    return internal::with_static_num_blocks(pattern, [&] (auto const static_num_blocks) {
+        return internal::best_alignment_with_cigar_with_static_num_blocks<decltype(static_num_blocks)::value>(
+            reference,
+            pattern,
+            max_num_errors
+        );
+    });
+}
+
+std::optional<alignment_with_cigar> best_alignment_with_cigar(
+    std::span<const uint8_t> const reference,
+    query_pattern const& pattern,
+    query_pattern const& reverse_pattern,
+    size_t const max_num_errors
+) {
+    auto const best_end = best_alignment_end(reference, pattern, max_num_errors, sequence_direction::forward);
+    if (!best_end.has_value()) {
+        return std::nullopt;
+    }
+
+    // an alignment that ends at the best end can start at most (query length + number of errors) before it
+    size_t const end_position = best_end->end_position;
+    size_t const window_begin = end_position - std::min(end_position, pattern.length() + best_end->num_errors);
+
+    auto const best_start = best_alignment_end(
+        reference.subspan(window_begin, end_position - window_begin),
+        reverse_pattern,
+        best_end->num_errors,
+        sequence_direction::reverse
+    );
+    assert(best_start.has_value() && best_start->num_errors == best_end->num_errors);
+
+    // All cells of the DP matrix that the traceback from the best end inspects and that lie on an optimal alignment
+    // have the same score in the tight window as in the whole reference, because the best start is not behind
+    // the start of any optimal alignment that ends at the best end. All other cells can only get larger scores.
+    // Therefore, the traceback in the window takes the same steps as the one in the whole reference.
+    size_t const start_position = end_position - best_start->end_position;
+
+    auto alignment = best_alignment_with_cigar(
+        reference.subspan(start_position, end_position - start_position),
+        pattern,
+        best_end->num_errors
+    );
+    assert(alignment.has_value() && alignment->num_errors == best_end->num_errors);
+
+    alignment->start_position += start_position;
+
+    return alignment;
+}
+
+} // namespace bit_parallel_alignment
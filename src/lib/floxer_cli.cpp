@@ -85,6 +85,42 @@ bool command_line_input::dont_erase_useless_anchors() const {
     return dont_erase_useless_anchors_.value;
 }
 
+bool command_line_input::interleaved_seed_search() const {
+    return interleaved_seed_search_.value;
+}
+
+size_t command_line_input::kmer_table_length() const {
+    return index_construction_options_.kmer_table_length.value;
+}
+
+bool command_line_input::joint_strand_search() const {
+    return joint_strand_search_.value;
+}
+
+std::string command_line_input::occurrence_table() const {
+    return index_construction_options_.occurrence_table.value;
+}
+
+size_t command_line_input::suffix_array_sampling_rate() const {
+    return index_construction_options_.suffix_array_sampling_rate.value;
+}
+
+size_t command_line_input::min_stripped_n_run_length() const {
+    return index_construction_options_.min_stripped_n_run_length.value;
+}
+
+size_t command_line_input::index_shard_size() const {
+    return index_construction_options_.index_shard_size.value;
+}
+
+std::vector<std::string> command_line_input::changed_options_of_new_indices() const {
+    return index_construction_options_.changed_options_of_new_indices();
+}
+
+std::string command_line_input::shard_search() const {
+    return shard_search_.value;
+}
+
 
 bool command_line_input::bottom_up_pex_tree_building() const {
     return bottom_up_pex_tree_building_.value;
@@ -102,6 +138,10 @@ bool command_line_input::direct_full_verification() const {
     return direct_full_verification_.value;
 }
 
+bool command_line_input::incremental_verification() const {
+    return incremental_verification_.value;
+}
+
 size_t command_line_input::num_anchors_per_verification_task() const {
     return num_anchors_per_verification_task_.value;
 }
@@ -114,6 +154,10 @@ bool command_line_input::without_cigar() const {
     return without_cigar_.value;
 }
 
+std::string command_line_input::alignment_implementation() const {
+    return alignment_implementation_.value;
+}
+
 
 std::optional<size_t> command_line_input::timeout_seconds() const {
     if (timeout_seconds_.value == 0) {
@@ -152,14 +196,24 @@ std::string command_line_input::command_line_call() const {
         anchor_choice_strategy_.command_line_call(),
         seed_sampling_step_size_.command_line_call(),
         dont_erase_useless_anchors() ? dont_erase_useless_anchors_.command_line_call() : "",
+        interleaved_seed_search() ? interleaved_seed_search_.command_line_call() : "",
+        kmer_table_length() > 0 ? index_construction_options_.kmer_table_length.command_line_call() : "",
+        joint_strand_search() ? joint_strand_search_.command_line_call() : "",
+        index_construction_options_.occurrence_table.command_line_call(),
+        index_construction_options_.suffix_array_sampling_rate.command_line_call(),
+        min_stripped_n_run_length() > 0 ? index_construction_options_.min_stripped_n_run_length.command_line_call() : "",
+        index_shard_size() > 0 ? index_construction_options_.index_shard_size.command_line_call() : "",
+        shard_search_.command_line_call(),
 
         bottom_up_pex_tree_building() ? bottom_up_pex_tree_building_.command_line_call() : "",
         use_interval_optimization() ? use_interval_optimization_.command_line_call() : "",
         extra_verification_ratio_.command_line_call(),
         direct_full_verification() ? direct_full_verification_.command_line_call() : "",
+        incremental_verification() ? incremental_verification_.command_line_call() : "",
 
         num_anchors_per_verification_task_.command_line_call(),
         without_cigar() ? without_cigar_.command_line_call() : "",
+        alignment_implementation_.command_line_call(),
 
         num_threads_.command_line_call(),
         timeout_seconds().has_value() ? timeout_seconds_.command_line_call() : "",
@@ -201,6 +255,93 @@ void command_line_input::validate() const {
             )
         );
     }
+
+    if (kmer_table_length() > 0 && !interleaved_seed_search()) {
+        throw std::runtime_error("The k-mer table can only be used with the interleaved seed search.");
+    }
+
+    if (joint_strand_search() && !interleaved_seed_search()) {
+        throw std::runtime_error("The joint strand search can only be used with the interleaved seed search.");
+    }
+
+    if (index_shard_size() > 0 && !index_path().has_value()) {
+        throw std::runtime_error("A sharded index can only be built with an index file path.");
+    }
+}
+
+void index_construction_options::add_to(sharg::parser& parser, bool const advanced) {
+    parser.add_option(kmer_table_length.value, sharg::config{
+        .short_id = kmer_table_length.short_id,
+        .long_id = kmer_table_length.long_id,
+        .description = "The length k of the k-mers in a table of FM index cursors, which lets the searches that start with "
+            "an exact match skip their first k steps. The table needs 24 * 4^k bytes of memory, is built together with "
+            "the index and saved in the index file. 0 means that no table is used. Only the interleaved seed search "
+            "of floxer uses it.",
+        .advanced = advanced,
+        .validator = sharg::arithmetic_range_validator{0ul, 14ul}
+    });
+
+    parser.add_option(occurrence_table.value, sharg::config{
+        .short_id = occurrence_table.short_id,
+        .long_id = occurrence_table.long_id,
+        .description = "The occurrence table of the FM-index that is built. The variants of the EPR table differ in the "
+            "width of their block counters, which trades the memory of the index against the speed of the search. "
+            "The dna4 variant contains only A, C, G and T. The references are split at N for it, such that no anchors "
+            "overlap an N of a reference and seeds that contain N are not searched. "
+            "It is stored in the index file and an existing index file is always loaded with its own table.",
+        .advanced = advanced,
+        .validator = sharg::value_list_validator{ std::vector{ "epr_v2_8", "epr_v2_16", "epr_v2_32", "epr_v2_16_dna4" } }
+    });
+
+    parser.add_option(suffix_array_sampling_rate.value, sharg::config{
+        .short_id = suffix_array_sampling_rate.short_id,
+        .long_id = suffix_array_sampling_rate.long_id,
+        .description = "Every n-th entry of the suffix array is stored in the FM-index that is built. Larger values make "
+            "the index smaller, but locating the anchors slower. The default (with the default occurrence table) leads to "
+            "an index size of about 11 GB for the human genome. An existing index file is always loaded with its own sampling rate.",
+        .advanced = advanced,
+        .validator = sharg::arithmetic_range_validator{1ul, 1024ul}
+    });
+
+    parser.add_option(min_stripped_n_run_length.value, sharg::config{
+        .short_id = min_stripped_n_run_length.short_id,
+        .long_id = min_stripped_n_run_length.long_id,
+        .description = "Remove all runs of at least this many N from the references before the FM-index is built. "
+            "This makes the index of assemblies with large gaps (like the human genome) smaller and faster to build. "
+            "The output coordinates don't change, but no anchors overlap a removed run. 0 keeps all N. "
+            "An existing index file is always loaded as it was built.",
+        .advanced = advanced
+    });
+
+    parser.add_option(index_shard_size.value, sharg::config{
+        .short_id = index_shard_size.short_id,
+        .long_id = index_shard_size.long_id,
+        .description = "Build a sharded index with at most this many bases per shard (except for longer single "
+            "references), for references that are too large for a single index in memory. Every shard is stored in "
+            "a file next to the index file (with the additional extension .shard<i>). 0 builds a single index. "
+            "An existing index file is always loaded as it was built.",
+        .advanced = advanced
+    });
+}
+
+std::vector<std::string> index_construction_options::changed_options_of_new_indices() const {
+    index_construction_options const defaults{};
+    std::vector<std::string> changed_options{};
+
+    if (occurrence_table.value != defaults.occurrence_table.value) {
+        changed_options.push_back(occurrence_table.long_id);
+    }
+    if (suffix_array_sampling_rate.value != defaults.suffix_array_sampling_rate.value) {
+        changed_options.push_back(suffix_array_sampling_rate.long_id);
+    }
+    if (min_stripped_n_run_length.value != defaults.min_stripped_n_run_length.value) {
+        changed_options.push_back(min_stripped_n_run_length.long_id);
+    }
+    if (index_shard_size.value != defaults.index_shard_size.value) {
+        changed_options.push_back(index_shard_size.long_id);
+    }
+
+    return changed_options;
 }
 
 void command_line_input::parse_and_validate(int argc, char ** argv) {
@@ -245,7 +386,9 @@ void command_line_input::parse_and_validate(int argc, char ** argv) {
         .long_id = index_path_.long_id,
         .description = "The file where the constructed FM-index will be stored for later use. "
             "If the file already exists, the index will be read "
-            "from it instead of newly constructed.",
+            "from it instead of newly constructed. The references are stored next to it "
+            "(with the additional extension .references), such that the reference file "
+            "doesn't need to be parsed again when the index is read.",
         .default_message = "no index file"
     });
 
@@ -352,6 +495,40 @@ void command_line_input::parse_and_validate(int argc, char ** argv) {
         .advanced = true
     });
 
+    parser.add_flag(interleaved_seed_search_.value, sharg::config{
+        .short_id = interleaved_seed_search_.short_id,
+        .long_id = interleaved_seed_search_.long_id,
+        .description = "Search the seeds of a query in the FM index in an interleaved fashion instead of one after another, "
+            "such that the memory accesses of many seeds overlap. This uses its own search implementation, which can report "
+            "the anchors in a different order and with a different number of raw anchors (which the max num anchors hard applies to).",
+        .advanced = true
+    });
+
+    parser.add_flag(joint_strand_search_.value, sharg::config{
+        .short_id = joint_strand_search_.short_id,
+        .long_id = joint_strand_search_.long_id,
+        .description = "Search the seeds of the forward query and of its reverse complement together in the bidirectional "
+            "FM index, such that both orientations share one traversal per search. The seeds of the reverse complement are "
+            "taken from the mirrored PEX tree in this case. Requires the interleaved seed search.",
+        .advanced = true
+    });
+
+    index_construction_options_.add_to(parser, true);
+
+    parser.add_option(shard_search_.value, sharg::config{
+        .short_id = shard_search_.short_id,
+        .long_id = shard_search_.long_id,
+        .description = "How the shards of a sharded index are searched. all_resident keeps all shards in memory and "
+            "searches every query in all of them, which reads the queries only once, but needs the memory of all "
+            "shards. The maximum numbers of anchors apply to the anchors of a seed in all shards together. "
+            "one_at_a_time only keeps one shard in memory and reads all queries once per shard. The maximum numbers "
+            "of anchors apply to every shard separately. The alignments of all queries are kept in memory until the "
+            "last shard was searched, so besides the memory of the largest shard, this needs memory for all "
+            "alignments of the whole query file.",
+        .advanced = true,
+        .validator = sharg::value_list_validator{ std::vector{ "all_resident", "one_at_a_time" } }
+    });
+
     parser.add_flag(bottom_up_pex_tree_building_.value, sharg::config{
         .short_id = bottom_up_pex_tree_building_.short_id,
         .long_id = bottom_up_pex_tree_building_.long_id,
@@ -383,6 +560,17 @@ void command_line_input::parse_and_validate(int argc, char ** argv) {
         .advanced = true
     });
 
+    parser.add_flag(incremental_verification_.value, sharg::config{
+        .short_id = incremental_verification_.short_id,
+        .long_id = incremental_verification_.long_id,
+        .description = "During the PEX hierarchical verification, restrict the reference span of every node "
+            "to the part that is compatible with the alignment ends of the previously verified child node. "
+            "The root is only aligned in that part, so the reported alignment can differ from the one without this "
+            "option if the query has another alignment of similar quality that doesn't contain the alignment of the "
+            "child. Only has an effect with the bit_parallel alignment implementation.",
+        .advanced = true
+    });
+
     parser.add_option(num_threads_.value, sharg::config{
         .short_id = num_threads_.short_id,
         .long_id = num_threads_.long_id,
@@ -401,10 +589,32 @@ void command_line_input::parse_and_validate(int argc, char ** argv) {
     parser.add_flag(without_cigar_.value, sharg::config{
         .short_id = without_cigar_.short_id,
         .long_id = without_cigar_.long_id,
-        .description = "Do not include CIGAR strings into output file. This reduces running time, and memory a lot.",
+        .description = "Do not include CIGAR strings into output file. With the seqan3 implementation, this reduces "
+            "running time and memory a lot. The bit_parallel implementation computes the CIGAR strings only in a tight "
+            "window around the best alignment, such that they are almost free for alignments with few errors.",
         .advanced = true
     });
 
+    parser.add_option(alignment_implementation_.value, sharg::config{
+        .short_id = alignment_implementation_.short_id,
+        .long_id = alignment_implementation_.long_id,
+        .description = "The implementation used for the verification alignments. The bit_parallel implementation "
+            "uses a dedicated banded bit-parallel kernel with a checkpointed traceback that needs much less memory "
+            "than the full traceback matrix of SeqAn3. It falls back to SeqAn3 when the number of allowed errors is "
+            "not smaller than the query length. The seqan3 implementation uses SeqAn3 for all alignments. "
+            "The wavefront implementation uses the wavefront algorithm, whose running time depends on the actual "
+            "number of errors instead of the allowed number of errors. It falls back to SeqAn3 like bit_parallel. "
+            "Alignments with a CIGAR and many errors are computed with the bit-parallel kernel instead, because the "
+            "traceback of the wavefront algorithm needs memory for all wavefronts. "
+            "The automatic implementation aligns the full queries with the wavefront algorithm as long as it is "
+            "estimated to be cheaper than the bit-parallel kernel, which is used otherwise. This is useful for "
+            "high-identity reads. The bit_parallel, wavefront and automatic implementations report the same alignments. "
+            "The seqan3 implementation reports alignments with the same number of errors, but it might choose a "
+            "different one of several equally good alignments.",
+        .advanced = true,
+        .validator = sharg::value_list_validator{ std::vector{ "bit_parallel", "seqan3", "wavefront", "automatic" } }
+    });
+
     parser.add_option(timeout_seconds_.value, sharg::config{
         .short_id = timeout_seconds_.short_id,
         .long_id = timeout_seconds_.long_id,
@@ -0,0 +1,117 @@
+#include <fmindex.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+// enough independent walks to hide the memory latency with the out-of-order execution of the CPU
+static constexpr size_t max_num_interleaved_walks = 32;
+
+struct locate_walk {
+    size_t row;
+    size_t num_steps;
+    size_t result_index;
+};
+
+occurrence_table_variant occurrence_table_variant_from_string(std::string_view const s) {
+    if (s == "epr_v2_8") {
+        return occurrence_table_variant::epr_v2_8;
+    } else if (s == "epr_v2_16") {
+        return occurrence_table_variant::epr_v2_16;
+    } else if (s == "epr_v2_32") {
+        return occurrence_table_variant::epr_v2_32;
+    } else if (s == "epr_v2_16_dna4") {
+        return occurrence_table_variant::epr_v2_16_dna4;
+    } else {
+        throw std::runtime_error("unexpected occurrence table value");
+    }
+}
+
+std::string to_string(occurrence_table_variant const variant) {
+    switch (variant) {
+        case occurrence_table_variant::epr_v2_8:
+            return "epr_v2_8";
+        case occurrence_table_variant::epr_v2_16:
+            return "epr_v2_16";
+        case occurrence_table_variant::epr_v2_32:
+            return "epr_v2_32";
+        case occurrence_table_variant::epr_v2_16_dna4:
+            return "epr_v2_16_dna4";
+        default:
+            throw std::runtime_error("(should be unreachable) internal bug in the occurrence table to string conversion");
+    }
+}
+
+occurrence_table_variant occurrence_table_variant_of(fmindex_variant const& index) {
+    return static_cast<occurrence_table_variant>(index.index());
+}
+
+fmindex_variant empty_fmindex(occurrence_table_variant const variant) {
+    switch (variant) {
+        case occurrence_table_variant::epr_v2_8:
+            return fmindex_epr_v2_8{};
+        case occurrence_table_variant::epr_v2_16:
+            return fmindex_epr_v2_16{};
+        case occurrence_table_variant::epr_v2_32:
+            return fmindex_epr_v2_32{};
+        case occurrence_table_variant::epr_v2_16_dna4:
+            return fmindex_dna4{};
+        default:
+            throw std::runtime_error("unexpected occurrence table variant");
+    }
+}
+
+template<typename index_t>
+std::vector<locate_result> locate_batch(index_t const& index, std::span<const size_t> const suffix_array_rows) {
+    std::vector<locate_result> results(suffix_array_rows.size());
+
+    std::vector<locate_walk> walks{};
+    walks.reserve(max_num_interleaved_walks);
+
+    size_t next_result_index = 0;
+
+    while (next_result_index < suffix_array_rows.size() || !walks.empty()) {
+        // refill the finished walks with new rows
+        while (walks.size() < max_num_interleaved_walks && next_result_index < suffix_array_rows.size()) {
+            walks.emplace_back(locate_walk {
+                .row = suffix_array_rows[next_result_index],
+                .num_steps = 0,
+                .result_index = next_result_index
+            });
+            ++next_result_index;
+        }
+
+        // one LF-mapping step for every walk that has not reached a sampled row yet.
+        // This is the same computation as in fmindex::locate
+        for (size_t walk_index = 0; walk_index < walks.size();) {
+            auto& walk = walks[walk_index];
+
+            auto const sampled_entry = index.csa.value(walk.row);
+            if (sampled_entry.has_value()) {
+                auto const [text_id, position] = *sampled_entry;
+                results[walk.result_index] = index.reference_position_of(text_id, position + walk.num_steps);
+
+                walk = walks.back();
+                walks.pop_back();
+                continue;
+            }
+
+            walk.row = index.occ.rank(walk.row, index.occ.symbol(walk.row));
+            ++walk.num_steps;
+
+            ++walk_index;
+        }
+    }
+
+    return results;
+}
+
+template std::vector<locate_result> locate_batch(fmindex_epr_v2_8 const&, std::span<const size_t> const);
+template std::vector<locate_result> locate_batch(fmindex_epr_v2_16 const&, std::span<const size_t> const);
+template std::vector<locate_result> locate_batch(fmindex_epr_v2_32 const&, std::span<const size_t> const);
+template std::vector<locate_result> locate_batch(fmindex_dna4 const&, std::span<const size_t> const);
+
+std::vector<locate_result> locate_batch(fmindex_variant const& index, std::span<const size_t> const suffix_array_rows) {
+    return std::visit([suffix_array_rows] (auto const& typed_index) {
+        return locate_batch(typed_index, suffix_array_rows);
+    }, index);
+}
@@ -0,0 +1,159 @@
+#include <index_construction.hpp>
+#include <output.hpp>
+
+#include <variant>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/stopwatch.h>
+
+namespace index_construction {
+
+std::vector<std::vector<uint8_t>> unpack_references(input::references const& references) {
+    std::vector<std::vector<uint8_t>> unpacked_references{};
+    unpacked_references.reserve(references.records.size());
+
+    for (auto const& record : references.records) {
+        unpacked_references.emplace_back(record.rank_sequence.unpack());
+    }
+
+    return unpacked_references;
+}
+
+fmindex_variant build_index(
+    std::vector<std::vector<uint8_t>> const& unpacked_references,
+    index_config const& config
+) {
+    spdlog::info(
+        "building index with the occurrence table {}, suffix array sampling rate {} and {} thread{}",
+        to_string(config.occurrence_table),
+        config.suffix_array_sampling_rate,
+        config.num_threads,
+        config.num_threads == 1 ? "" : "s"
+    );
+
+    spdlog::stopwatch const build_index_stopwatch;
+
+    // The default sampling rate is a trade-off for high speed. It leads to and index size of 11G
+    // for the human genome, which should be tolerable in most applications
+    auto index = build_fmindex(
+        config.occurrence_table,
+        unpacked_references,
+        config.suffix_array_sampling_rate,
+        config.num_threads,
+        config.min_stripped_n_run_length
+    );
+
+    spdlog::info(
+        "building index took {}",
+        output::format_elapsed_time(build_index_stopwatch.elapsed())
+    );
+
+    if (config.min_stripped_n_run_length > 0) {
+        size_t const num_fragments = std::visit([] (auto const& typed_index) {
+            return typed_index.get_fragments().size();
+        }, index);
+
+        if (num_fragments == 0) {
+            spdlog::info("no run of at least {} N was found in the references", config.min_stripped_n_run_length);
+        } else {
+            spdlog::info(
+                "removed all runs of at least {} N, the index contains {} fragments of the references",
+                config.min_stripped_n_run_length,
+                num_fragments
+            );
+        }
+    }
+
+    return index;
+}
+
+fmindex_variant build_index(input::references const& references, index_config const& config) {
+    return build_index(unpack_references(references), config);
+}
+
+kmer_cursor_table build_kmer_table(fmindex_variant const& index, size_t const kmer_length) {
+    spdlog::info("building k-mer table with k = {}", kmer_length);
+    spdlog::stopwatch const build_kmer_table_stopwatch;
+
+    auto table = std::visit([kmer_length] (auto const& typed_index) {
+        return kmer_cursor_table(typed_index, kmer_length);
+    }, index);
+
+    spdlog::info(
+        "building k-mer table took {}",
+        output::format_elapsed_time(build_kmer_table_stopwatch.elapsed())
+    );
+
+    return table;
+}
+
+std::vector<index_shard_range> partition_references_into_shards(
+    input::references const& references,
+    size_t const max_shard_length
+) {
+    std::vector<index_shard_range> shard_ranges{};
+    size_t current_shard_length = 0;
+
+    for (size_t reference_id = 0; reference_id < references.records.size(); ++reference_id) {
+        size_t const reference_length = references.records[reference_id].rank_sequence.size();
+
+        if (shard_ranges.empty() || current_shard_length + reference_length > max_shard_length) {
+            shard_ranges.emplace_back(index_shard_range {
+                .first_reference_id = reference_id,
+                .num_references = 0
+            });
+            current_shard_length = 0;
+        }
+
+        ++shard_ranges.back().num_references;
+        current_shard_length += reference_length;
+    }
+
+    return shard_ranges;
+}
+
+std::vector<std::vector<uint8_t>> unpack_references(
+    input::references const& references,
+    index_shard_range const shard_range
+) {
+    std::vector<std::vector<uint8_t>> unpacked_references{};
+    unpacked_references.reserve(shard_range.num_references);
+
+    for (size_t i = 0; i < shard_range.num_references; ++i) {
+        unpacked_references.emplace_back(references.records[shard_range.first_reference_id + i].rank_sequence.unpack());
+    }
+
+    return unpacked_references;
+}
+
+void build_and_save_index_shards(
+    input::references const& references,
+    std::vector<index_shard_range> const& shard_ranges,
+    index_config const& config,
+    size_t const kmer_table_length,
+    std::filesystem::path const& index_path
+) {
+    for (size_t shard_id = 0; shard_id < shard_ranges.size(); ++shard_id) {
+        auto const& shard_range = shard_ranges[shard_id];
+        spdlog::info(
+            "building index shard {} of {} with {} reference{}",
+            shard_id + 1,
+            shard_ranges.size(),
+            shard_range.num_references,
+            shard_range.num_references == 1 ? "" : "s"
+        );
+
+        auto const index = build_index(unpack_references(references, shard_range), config);
+
+        kmer_cursor_table kmer_table{};
+        if (kmer_table_length > 0) {
+            kmer_table = build_kmer_table(index, kmer_table_length);
+        }
+
+        output::save_index(index, kmer_table, input::shard_path_of_index(index_path, shard_id));
+    }
+
+    output::save_index_shard_ranges(shard_ranges, index_path);
+}
+
+} // namespace index_construction
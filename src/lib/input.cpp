@@ -1,12 +1,16 @@
 #include <input.hpp>
 #include <math.hpp>
+#include <multiversioning.hpp>
 
 #include <algorithm>
 #include <fstream>
 #include <numeric>
 #include <ranges>
 #include <sstream>
+#include <stdexcept>
+#include <type_traits>
 #include <unordered_set>
+#include <variant>
 
 #include <cereal/archives/binary.hpp>
 #include <cereal/types/array.hpp>
@@ -33,6 +37,12 @@ size_t num_errors_from_user_config(size_t const query_length, cli::command_line_
     }
 }
 
+bool num_errors_fit_query_length(size_t const query_length, cli::command_line_input const& cli_input) {
+    size_t const query_num_errors = num_errors_from_user_config(query_length, cli_input);
+
+    return query_length > query_num_errors && query_num_errors >= cli_input.pex_seed_num_errors();
+}
+
 references read_references(std::filesystem::path const& reference_sequence_path) {
     spdlog::info("reading reference sequences from {}", reference_sequence_path);
 
@@ -61,7 +71,7 @@ references read_references(std::filesystem::path const& reference_sequence_path)
 
         records.emplace_back(
             std::move(id),
-            std::move(rank_sequence),
+            packed_rank_sequence(rank_sequence),
             internal_id
         );
 
@@ -109,13 +119,8 @@ std::optional<query_record> queries::next() {
             continue;
         }
 
-        // two cases that likely don't occur in practice where the errors are configured in a way such that the
-        // alignment algorithm makes no sense and floxer just flags them as unaligned
-        size_t const query_num_errors = num_errors_from_user_config(sequence_length, cli_input);
-        if (
-            sequence_length <= query_num_errors ||
-            query_num_errors < cli_input.pex_seed_num_errors()
-        ) {
+        if (!num_errors_fit_query_length(sequence_length, cli_input)) {
+            size_t const query_num_errors = num_errors_from_user_config(sequence_length, cli_input);
             spdlog::warn(
                 "skipping query: {} due to bad configuration regarding the number of errors.\n"
                 "\tquery length: {}, errors in query: {}, PEX seed errors: {}",
@@ -129,7 +134,8 @@ std::optional<query_record> queries::next() {
         }
 
         std::vector<uint8_t> const rank_sequence = internal::chars_to_rank_sequence(record_view.seq);
-        std::vector<uint8_t> const reverse_complement_rank_sequence = ivs::reverse_complement_rank<floxer_alphabet_t>(rank_sequence);
+        std::vector<uint8_t> const reverse_complement_rank_sequence =
+            internal::reverse_complement_rank_sequence(rank_sequence);
 
         std::string const quality(record_view.qual);
 
@@ -147,21 +153,161 @@ std::optional<query_record> queries::next() {
     }
 }
 
-fmindex load_index(std::filesystem::path const& index_path) {
+std::filesystem::path references_path_of_index(std::filesystem::path const& index_path) {
+    auto references_path = index_path;
+    references_path += ".references";
+
+    return references_path;
+}
+
+std::optional<references> load_references(std::filesystem::path const& references_path) {
+    if (!std::filesystem::exists(references_path)) {
+        return std::nullopt;
+    }
+
+    spdlog::info("reading reference sequences from {}", references_path);
+
+    auto ifs = std::ifstream(references_path, std::ios::binary);
+
+    std::string marker(references_file_marker.size(), '\0');
+    ifs.read(marker.data(), marker.size());
+    if (!ifs || marker != references_file_marker) {
+        spdlog::info("the references file {} was written by another version of floxer", references_path);
+        return std::nullopt;
+    }
+
+    auto archive = cereal::BinaryInputArchive{ifs};
+
+    size_t num_records = 0;
+    archive(num_records);
+
+    std::vector<reference_record> records{};
+    records.reserve(num_records);
+    size_t total_length = 0;
+
+    for (size_t internal_id = 0; internal_id < num_records; ++internal_id) {
+        std::string id;
+        packed_rank_sequence rank_sequence;
+        archive(id, rank_sequence);
+
+        total_length += rank_sequence.size();
+
+        records.emplace_back(std::move(id), std::move(rank_sequence), internal_id);
+    }
+
+    if (records.empty()) {
+        throw std::runtime_error("The references file " + references_path.string() + " is empty.");
+    }
+
+    return references { .records = std::move(records), .total_sequence_length = total_length };
+}
+
+// reads the header of the index file, such that the index itself is read next
+struct index_file_header {
+    occurrence_table_variant variant;
+    bool has_fragment_table;
+};
+
+static index_file_header read_index_file_header(std::ifstream& ifs) {
+    std::string marker(index_file_marker.size(), '\0');
+    ifs.read(marker.data(), marker.size());
+
+    if (!ifs || (marker != index_file_marker && marker != index_file_marker_v1)) {
+        // index files written by older versions start directly with the index
+        ifs.clear();
+        ifs.seekg(0);
+        return index_file_header {
+            .variant = occurrence_table_variant::epr_v2_16,
+            .has_fragment_table = false
+        };
+    }
+
+    char variant_value = 0;
+    ifs.read(&variant_value, 1);
+    if (!ifs) {
+        throw std::runtime_error("The index file ends after its header.");
+    }
+
+    auto const variant = static_cast<occurrence_table_variant>(variant_value);
+
+    return index_file_header {
+        .variant = variant,
+        .has_fragment_table = marker == index_file_marker || variant == occurrence_table_variant::epr_v2_16_dna4
+    };
+}
+
+static fmindex_variant read_index(std::ifstream& ifs, cereal::BinaryInputArchive& archive) {
+    auto const header = read_index_file_header(ifs);
+    auto index = empty_fmindex(header.variant);
+
+    std::visit([&archive, &header] (auto& typed_index) {
+        if (header.has_fragment_table) {
+            archive(typed_index);
+        } else {
+            // the texts of the index are the references
+            using base_index_t = typename std::remove_cvref_t<decltype(typed_index)>::base_index_t;
+            archive(static_cast<base_index_t&>(typed_index));
+        }
+    }, index);
+
+    return index;
+}
+
+fmindex_variant load_index(std::filesystem::path const& index_path) {
+    auto ifs     = std::ifstream(index_path, std::ios::binary);
+    auto archive = cereal::BinaryInputArchive{ifs};
+
+    return read_index(ifs, archive);
+}
+
+fmindex_variant load_index(std::filesystem::path const& index_path, kmer_cursor_table& out_kmer_table) {
     auto ifs     = std::ifstream(index_path, std::ios::binary);
     auto archive = cereal::BinaryInputArchive{ifs};
-    auto index = fmindex{};
-    archive(index);
+    auto index = read_index(ifs, archive);
+
+    // index files written by older versions end after the index
+    out_kmer_table = kmer_cursor_table{};
+    if (ifs.peek() != std::ifstream::traits_type::eof()) {
+        archive(out_kmer_table);
+    }
 
     return index;
 }
 
+std::optional<std::vector<index_shard_range>> load_index_shard_ranges(std::filesystem::path const& index_path) {
+    auto ifs = std::ifstream(index_path, std::ios::binary);
+
+    std::string marker(index_shards_file_marker.size(), '\0');
+    ifs.read(marker.data(), marker.size());
+    if (!ifs || marker != index_shards_file_marker) {
+        return std::nullopt;
+    }
+
+    auto archive = cereal::BinaryInputArchive{ifs};
+    std::vector<index_shard_range> shard_ranges{};
+    archive(shard_ranges);
+
+    if (shard_ranges.empty()) {
+        throw std::runtime_error("The sharded index file " + index_path.string() + " contains no shards.");
+    }
+
+    return shard_ranges;
+}
+
+std::filesystem::path shard_path_of_index(std::filesystem::path const& index_path, size_t const shard_id) {
+    auto shard_path = index_path;
+    shard_path += ".shard" + std::to_string(shard_id);
+
+    return shard_path;
+}
+
 namespace internal {
 
 std::string extract_record_id(std::string_view const& record_tag) {
     return std::string(record_tag.begin(), std::ranges::find(record_tag, ' '));
 }
 
+FLOXER_MULTIVERSIONED
 std::vector<uint8_t> chars_to_rank_sequence(std::string_view const sequence) {
     auto rank_sequence = ivs::convert_char_to_rank<floxer_alphabet_t>(sequence);
 
@@ -175,6 +321,11 @@ std::vector<uint8_t> chars_to_rank_sequence(std::string_view const sequence) {
     return rank_sequence;
 }
 
+FLOXER_MULTIVERSIONED
+std::vector<uint8_t> reverse_complement_rank_sequence(std::vector<uint8_t> const& rank_sequence) {
+    return ivs::reverse_complement_rank<floxer_alphabet_t>(rank_sequence);
+}
+
 } // namespace internal
 
 } // namespace input
@@ -0,0 +1,531 @@
+#include <interleaved_search.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <optional>
+
+namespace interleaved_search {
+
+namespace internal {
+
+// enough independent traversals to hide the memory latency of the rank queries with the out-of-order execution
+// of the CPU
+static constexpr size_t max_num_interleaved_traversals = 16;
+
+static constexpr size_t forward_index = 0;
+static constexpr size_t reverse_complement_index = 1;
+static constexpr size_t max_num_orientations = 2;
+
+enum class extension_direction {
+    left, right
+};
+
+static extension_direction opposite(extension_direction const direction) {
+    return direction == extension_direction::left ? extension_direction::right : extension_direction::left;
+}
+
+// A, C, G, T have the ranks 1 to 4, N (5) and the sentinel (0) stay the same
+static size_t complement_rank(size_t const rank) {
+    return rank >= 1 && rank <= 4 ? 5 - rank : rank;
+}
+
+enum class operation {
+    none, match_or_substitution, insertion, deletion
+};
+
+template<typename cursor_t>
+struct node {
+    // The cursors of the seed and of its reverse complement, if both orientations are searched. The reverse
+    // complement is extended in the opposite direction with the complemented characters, such that every character
+    // and error of the traversal applies to both. An orientation that has no occurrences left has an empty cursor
+    std::array<cursor_t, max_num_orientations> cursors;
+    size_t num_consumed_positions; // the index of the next step in the search
+    size_t num_errors;
+    operation last_left_operation;
+    operation last_right_operation;
+};
+
+template<typename cursor_t>
+struct traversal {
+    size_t seed_index;
+    search_schemes::Search const* search;
+    std::vector<extension_direction> directions;
+    std::vector<node<cursor_t>> stack;
+};
+
+template<typename index_t>
+class interleaved_searcher {
+    using cursor_t = cursor_of_index_t<index_t>;
+    using node_t = node<cursor_t>;
+    using traversal_t = traversal<cursor_t>;
+
+public:
+    interleaved_searcher(
+        index_t const& index_,
+        kmer_cursor_table const& kmer_table_,
+        std::span<const search::seed> const seeds_,
+        std::span<search_schemes::Scheme const* const> const search_schemes_of_seeds_,
+        size_t const max_num_raw_anchors_per_seed_,
+        size_t const num_orientations_
+    ) : index{index_},
+        kmer_table{kmer_table_},
+        seeds{seeds_},
+        search_schemes_of_seeds{search_schemes_of_seeds_},
+        max_num_raw_anchors_per_seed{max_num_raw_anchors_per_seed_},
+        num_orientations{num_orientations_} {
+        for (size_t orientation = 0; orientation < num_orientations; ++orientation) {
+            results[orientation].resize(
+                seeds.size(),
+                seed_search_result{ .anchor_groups{}, .total_num_raw_anchors = 0 }
+            );
+        }
+    }
+
+    std::array<std::vector<seed_search_result>, max_num_orientations> run() {
+        std::vector<traversal_t> active_traversals{};
+        active_traversals.reserve(max_num_interleaved_traversals);
+
+        while (true) {
+            while (active_traversals.size() < max_num_interleaved_traversals && has_pending_traversal()) {
+                active_traversals.emplace_back(next_pending_traversal());
+            }
+
+            if (active_traversals.empty()) {
+                break;
+            }
+
+            // one node per traversal and turn, such that the rank queries of different traversals can overlap
+            for (size_t traversal_index = 0; traversal_index < active_traversals.size();) {
+                auto& t = active_traversals[traversal_index];
+
+                if (t.stack.empty() || is_seed_finished(t.seed_index)) {
+                    t = std::move(active_traversals.back());
+                    active_traversals.pop_back();
+                    continue;
+                }
+
+                expand_next_node(t);
+                ++traversal_index;
+            }
+        }
+
+        return std::move(results);
+    }
+
+private:
+    bool is_orientation_finished(size_t const orientation, size_t const seed_index) const {
+        return results[orientation][seed_index].total_num_raw_anchors >= max_num_raw_anchors_per_seed;
+    }
+
+    bool is_seed_finished(size_t const seed_index) const {
+        for (size_t orientation = 0; orientation < num_orientations; ++orientation) {
+            if (!is_orientation_finished(orientation, seed_index)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    cursor_t empty_cursor() const {
+        cursor_t cursor(index);
+        cursor.len = 0;
+        return cursor;
+    }
+
+    bool has_any_cursor(node_t const& n) const {
+        for (size_t orientation = 0; orientation < num_orientations; ++orientation) {
+            if (!n.cursors[orientation].empty()) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool has_pending_traversal() {
+        // skip the seeds without remaining searches, the ones that already have enough anchors and the ones with
+        // characters that the index doesn't contain
+        while (
+            next_seed_index < seeds.size() && (
+                next_search_index >= search_schemes_of_seeds[next_seed_index]->size() ||
+                is_seed_finished(next_seed_index) ||
+                (next_search_index == 0 && !is_in_alphabet_of_index<index_t>(seeds[next_seed_index].sequence))
+            )
+        ) {
+            ++next_seed_index;
+            next_search_index = 0;
+        }
+
+        return next_seed_index < seeds.size();
+    }
+
+    traversal_t next_pending_traversal() {
+        auto const& search = (*search_schemes_of_seeds[next_seed_index])[next_search_index];
+        assert(search.pi.size() == seeds[next_seed_index].sequence.size());
+
+        // the search schemes are connected, every step extends the part of the seed that was already searched
+        std::vector<extension_direction> directions(search.pi.size());
+        for (size_t step = 0; step < search.pi.size(); ++step) {
+            size_t const first_position = search.pi[0];
+            bool const goes_right = step == 0 ?
+                search.pi.size() > 1 && search.pi[1] > first_position
+                : search.pi[step] > first_position;
+
+            directions[step] = goes_right ? extension_direction::right : extension_direction::left;
+        }
+
+        traversal_t t {
+            .seed_index = next_seed_index,
+            .search = &search,
+            .directions = std::move(directions),
+            .stack{}
+        };
+
+        auto const kmer_start_node = start_node_from_kmer_table(search, seeds[next_seed_index]);
+        if (!kmer_start_node.has_value()) {
+            node_t root {
+                .cursors{},
+                .num_consumed_positions = 0,
+                .num_errors = 0,
+                .last_left_operation = operation::none,
+                .last_right_operation = operation::none
+            };
+            for (size_t orientation = 0; orientation < max_num_orientations; ++orientation) {
+                root.cursors[orientation] = orientation < num_orientations ? cursor_t(index) : empty_cursor();
+            }
+
+            push(t, root);
+        } else if (has_any_cursor(*kmer_start_node)) {
+            push(t, *kmer_start_node);
+        }
+
+        ++next_search_index;
+
+        return t;
+    }
+
+    // If the search starts with an exact match of (at least) k characters, the traversal can start at depth k with
+    // the cursor of this k-mer from the table. std::nullopt if this is not the case or the k-mer contains an N
+    std::optional<node_t> start_node_from_kmer_table(
+        search_schemes::Search const& search,
+        search::seed const& seed
+    ) const {
+        size_t const kmer_length = kmer_table.kmer_length();
+
+        if (kmer_table.empty() || kmer_length >= search.pi.size()) {
+            return std::nullopt;
+        }
+
+        for (size_t step = 0; step < kmer_length; ++step) {
+            if (search.u[step] > 0) {
+                return std::nullopt;
+            }
+        }
+
+        // the first k positions are contiguous, because the search scheme is connected
+        size_t const first_position = std::ranges::min(std::span(search.pi).first(kmer_length));
+        auto const kmer = seed.sequence.subspan(first_position, kmer_length);
+
+        auto const cursor = kmer_table.cursor_of(index, kmer);
+        if (!cursor.has_value()) {
+            return std::nullopt;
+        }
+
+        node_t start_node {
+            .cursors{ *cursor, empty_cursor() },
+            .num_consumed_positions = kmer_length,
+            .num_errors = 0,
+            .last_left_operation = operation::match_or_substitution,
+            .last_right_operation = operation::match_or_substitution
+        };
+
+        if (num_orientations > 1) {
+            std::vector<uint8_t> reverse_complement_kmer(kmer.rbegin(), kmer.rend());
+            std::ranges::transform(reverse_complement_kmer, reverse_complement_kmer.begin(), complement_rank);
+
+            // the k-mer and its reverse complement both consist only of A, C, G and T
+            start_node.cursors[reverse_complement_index] = *kmer_table.cursor_of(index, reverse_complement_kmer);
+        }
+
+        return start_node;
+    }
+
+    void push(traversal_t& t, node_t const& n) const {
+        // finished nodes are reported before they are pushed
+        assert(n.num_consumed_positions < t.search->pi.size());
+
+        t.stack.push_back(n);
+    }
+
+    void report(node_t const& n, size_t const seed_index, size_t const num_errors) {
+        for (size_t orientation = 0; orientation < num_orientations; ++orientation) {
+            auto const& cursor = n.cursors[orientation];
+            if (cursor.empty() || is_orientation_finished(orientation, seed_index)) {
+                continue;
+            }
+
+            auto& result = results[orientation][seed_index];
+            result.anchor_groups.emplace_back(search::internal::anchor_group {
+                .suffix_array_begin = cursor.lb,
+                .suffix_array_end = cursor.lb + cursor.count(),
+                .num_errors = num_errors
+            });
+            result.total_num_raw_anchors += cursor.count();
+        }
+    }
+
+    void expand_next_node(traversal_t& t) {
+        node_t const n = t.stack.back();
+        t.stack.pop_back();
+
+        auto const& search = *t.search;
+        auto const& seed = seeds[t.seed_index];
+        size_t const step = n.num_consumed_positions;
+        size_t const query_position = search.pi[step];
+        size_t const query_rank = seed.sequence[query_position];
+        auto const direction = t.directions[step];
+
+        bool const is_last_step = step + 1 == search.pi.size();
+        bool const is_at_end_of_seed = query_position == 0 || query_position + 1 == seed.sequence.size();
+        // a deletion in the first step would be placed on the other side of the query position
+        bool const deletion_is_outside_of_seed = step == 0 && (
+            direction == extension_direction::right ?
+                query_position == 0 : query_position + 1 == seed.sequence.size()
+        );
+        operation const last_operation = direction == extension_direction::left ?
+            n.last_left_operation : n.last_right_operation;
+
+        // the node with the given cursors and number of errors after an operation in this step
+        auto const child_of = [&] (
+            std::array<cursor_t, max_num_orientations> const& cursors,
+            size_t const num_consumed_positions,
+            size_t const num_errors,
+            operation const op
+        ) {
+            node_t child {
+                .cursors = cursors,
+                .num_consumed_positions = num_consumed_positions,
+                .num_errors = num_errors,
+                .last_left_operation = n.last_left_operation,
+                .last_right_operation = n.last_right_operation
+            };
+
+            if (direction == extension_direction::left) {
+                child.last_left_operation = op;
+            } else {
+                child.last_right_operation = op;
+            }
+
+            return child;
+        };
+
+        // consumes the query position of this step
+        auto const consume = [&] (
+            std::array<cursor_t, max_num_orientations> const& cursors,
+            size_t const num_errors,
+            operation const op
+        ) {
+            if (
+                num_errors < search.l[step] ||
+                num_errors > search.u[step] ||
+                is_seed_finished(t.seed_index)
+            ) {
+                return;
+            }
+
+            auto const child = child_of(cursors, step + 1, num_errors, op);
+
+            if (is_last_step) {
+                report(child, t.seed_index, num_errors);
+                return;
+            }
+
+            push(t, child);
+        };
+
+        // the extension of the reverse complement by the complement of a rank is stored at the index of the rank
+        std::array<std::array<cursor_t, index_t::Sigma>, max_num_orientations> extended_cursors{};
+        for (size_t orientation = 0; orientation < max_num_orientations; ++orientation) {
+            auto const& cursor = n.cursors[orientation];
+
+            if (cursor.empty() || orientation >= num_orientations || is_orientation_finished(orientation, t.seed_index)) {
+                extended_cursors[orientation].fill(empty_cursor());
+                continue;
+            }
+
+            auto const orientation_direction = orientation == forward_index ? direction : opposite(direction);
+            auto const extended = orientation_direction == extension_direction::left ?
+                cursor.extendLeft() : cursor.extendRight();
+
+            for (size_t rank = 0; rank < index_t::Sigma; ++rank) {
+                extended_cursors[orientation][rank] = orientation == forward_index ?
+                    extended[rank] : extended[complement_rank(rank)];
+            }
+        }
+
+        auto const cursors_of_rank = [&extended_cursors] (size_t const rank) {
+            return std::array<cursor_t, max_num_orientations>{
+                extended_cursors[forward_index][rank],
+                extended_cursors[reverse_complement_index][rank]
+            };
+        };
+
+        // the sentinel (rank 0) is never part of an occurrence
+        for (size_t rank = 1; rank < index_t::Sigma; ++rank) {
+            auto const cursors = cursors_of_rank(rank);
+            if (cursors[forward_index].empty() && cursors[reverse_complement_index].empty()) {
+                continue;
+            }
+
+            consume(
+                cursors,
+                n.num_errors + (rank == query_rank ? 0 : 1),
+                operation::match_or_substitution
+            );
+        }
+
+        // the query position is skipped
+        if (!is_at_end_of_seed && last_operation != operation::deletion) {
+            consume(n.cursors, n.num_errors + 1, operation::insertion);
+        }
+
+        // a reference character is added in front of the query position
+        if (
+            !deletion_is_outside_of_seed &&
+            last_operation != operation::insertion &&
+            n.num_errors + 1 <= search.u[step]
+        ) {
+            for (size_t rank = 1; rank < index_t::Sigma; ++rank) {
+                auto const cursors = cursors_of_rank(rank);
+                if (cursors[forward_index].empty() && cursors[reverse_complement_index].empty()) {
+                    continue;
+                }
+
+                push(t, child_of(cursors, step, n.num_errors + 1, operation::deletion));
+            }
+        }
+    }
+
+    index_t const& index;
+    kmer_cursor_table const& kmer_table;
+    std::span<const search::seed> const seeds;
+    std::span<search_schemes::Scheme const* const> const search_schemes_of_seeds;
+    size_t const max_num_raw_anchors_per_seed;
+    size_t const num_orientations;
+
+    std::array<std::vector<seed_search_result>, max_num_orientations> results{};
+    size_t next_seed_index = 0;
+    size_t next_search_index = 0;
+};
+
+} // namespace internal
+
+template<typename index_t>
+std::vector<seed_search_result> search_seeds(
+    index_t const& index,
+    kmer_cursor_table const& kmer_table,
+    std::span<const search::seed> const seeds,
+    std::span<search_schemes::Scheme const* const> const search_schemes_of_seeds,
+    size_t const max_num_raw_anchors_per_seed
+) {
+    assert(seeds.size() == search_schemes_of_seeds.size());
+
+    internal::interleaved_searcher<index_t> searcher(
+        index,
+        kmer_table,
+        seeds,
+        search_schemes_of_seeds,
+        max_num_raw_anchors_per_seed,
+        1
+    );
+
+    return std::move(searcher.run()[internal::forward_index]);
+}
+
+template<typename index_t>
+both_orientations_result search_seeds_of_both_orientations(
+    index_t const& index,
+    kmer_cursor_table const& kmer_table,
+    std::span<const search::seed> const seeds,
+    std::span<search_schemes::Scheme const* const> const search_schemes_of_seeds,
+    size_t const max_num_raw_anchors_per_seed
+) {
+    assert(seeds.size() == search_schemes_of_seeds.size());
+
+    internal::interleaved_searcher<index_t> searcher(
+        index,
+        kmer_table,
+        seeds,
+        search_schemes_of_seeds,
+        max_num_raw_anchors_per_seed,
+        internal::max_num_orientations
+    );
+
+    auto results = searcher.run();
+
+    return both_orientations_result {
+        .forward = std::move(results[internal::forward_index]),
+        .reverse_complement = std::move(results[internal::reverse_complement_index])
+    };
+}
+
+template std::vector<seed_search_result> search_seeds(
+    fmindex_epr_v2_8 const&,
+    kmer_cursor_table const&,
+    std::span<const search::seed> const,
+    std::span<search_schemes::Scheme const* const> const,
+    size_t const
+);
+template std::vector<seed_search_result> search_seeds(
+    fmindex_epr_v2_16 const&,
+    kmer_cursor_table const&,
+    std::span<const search::seed> const,
+    std::span<search_schemes::Scheme const* const> const,
+    size_t const
+);
+template std::vector<seed_search_result> search_seeds(
+    fmindex_epr_v2_32 const&,
+    kmer_cursor_table const&,
+    std::span<const search::seed> const,
+    std::span<search_schemes::Scheme const* const> const,
+    size_t const
+);
+template std::vector<seed_search_result> search_seeds(
+    fmindex_dna4 const&,
+    kmer_cursor_table const&,
+    std::span<const search::seed> const,
+    std::span<search_schemes::Scheme const* const> const,
+    size_t const
+);
+template both_orientations_result search_seeds_of_both_orientations(
+    fmindex_epr_v2_8 const&,
+    kmer_cursor_table const&,
+    std::span<const search::seed> const,
+    std::span<search_schemes::Scheme const* const> const,
+    size_t const
+);
+template both_orientations_result search_seeds_of_both_orientations(
+    fmindex_epr_v2_16 const&,
+    kmer_cursor_table const&,
+    std::span<const search::seed> const,
+    std::span<search_schemes::Scheme const* const> const,
+    size_t const
+);
+template both_orientations_result search_seeds_of_both_orientations(
+    fmindex_epr_v2_32 const&,
+    kmer_cursor_table const&,
+    std::span<const search::seed> const,
+    std::span<search_schemes::Scheme const* const> const,
+    size_t const
+);
+template both_orientations_result search_seeds_of_both_orientations(
+    fmindex_dna4 const&,
+    kmer_cursor_table const&,
+    std::span<const search::seed> const,
+    std::span<search_schemes::Scheme const* const> const,
+    size_t const
+);
+
+} // namespace interleaved_search
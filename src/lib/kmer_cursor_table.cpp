@@ -0,0 +1,102 @@
+#include <kmer_cursor_table.hpp>
+
+#include <cassert>
+
+static constexpr size_t first_dna_rank = 1;
+static constexpr size_t dna_alphabet_size = 4;
+
+template<typename index_t>
+kmer_cursor_table::kmer_cursor_table(index_t const& index, size_t const kmer_length)
+    : kmer_length_{kmer_length} {
+    size_t num_kmers = 1;
+    for (size_t i = 0; i < kmer_length; ++i) {
+        num_kmers *= dna_alphabet_size;
+    }
+
+    // the entries of k-mers that do not occur stay empty
+    entries.resize(num_kmers, entry{ .suffix_array_begin = 0, .reverse_suffix_array_begin = 0, .count = 0 });
+
+    if (kmer_length > 0) {
+        fill_entries(cursor_of_index_t<index_t>(index), 0, 0);
+    }
+}
+
+size_t kmer_cursor_table::kmer_length() const {
+    return kmer_length_;
+}
+
+bool kmer_cursor_table::empty() const {
+    return kmer_length_ == 0;
+}
+
+template<typename index_t>
+std::optional<cursor_of_index_t<index_t>> kmer_cursor_table::cursor_of(
+    index_t const& index,
+    std::span<const uint8_t> const kmer
+) const {
+    assert(kmer.size() == kmer_length_);
+
+    size_t kmer_code = 0;
+    for (uint8_t const rank : kmer) {
+        if (rank < first_dna_rank || rank >= first_dna_rank + dna_alphabet_size) {
+            return std::nullopt;
+        }
+
+        kmer_code = kmer_code * dna_alphabet_size + (rank - first_dna_rank);
+    }
+
+    auto const& e = entries[kmer_code];
+
+    cursor_of_index_t<index_t> cursor(index);
+    cursor.lb = e.suffix_array_begin;
+    cursor.lbRev = e.reverse_suffix_array_begin;
+    cursor.len = e.count;
+
+    return cursor;
+}
+
+// extends the cursors to the right in a depth-first traversal of all k-mers, stopping at empty cursors
+template<typename cursor_t>
+void kmer_cursor_table::fill_entries(cursor_t const& cursor, size_t const depth, size_t const kmer_code) {
+    if (depth == kmer_length_) {
+        entries[kmer_code] = entry {
+            .suffix_array_begin = cursor.lb,
+            .reverse_suffix_array_begin = cursor.lbRev,
+            .count = cursor.count()
+        };
+
+        return;
+    }
+
+    auto const extended_cursors = cursor.extendRight();
+
+    for (size_t i = 0; i < dna_alphabet_size; ++i) {
+        auto const& extended_cursor = extended_cursors[first_dna_rank + i];
+
+        if (!extended_cursor.empty()) {
+            fill_entries(extended_cursor, depth + 1, kmer_code * dna_alphabet_size + i);
+        }
+    }
+}
+
+template kmer_cursor_table::kmer_cursor_table(fmindex_epr_v2_8 const&, size_t const);
+template kmer_cursor_table::kmer_cursor_table(fmindex_epr_v2_16 const&, size_t const);
+template kmer_cursor_table::kmer_cursor_table(fmindex_epr_v2_32 const&, size_t const);
+template kmer_cursor_table::kmer_cursor_table(fmindex_dna4 const&, size_t const);
+
+template std::optional<cursor_of_index_t<fmindex_epr_v2_8>> kmer_cursor_table::cursor_of(
+    fmindex_epr_v2_8 const&,
+    std::span<const uint8_t> const
+) const;
+template std::optional<cursor_of_index_t<fmindex_epr_v2_16>> kmer_cursor_table::cursor_of(
+    fmindex_epr_v2_16 const&,
+    std::span<const uint8_t> const
+) const;
+template std::optional<cursor_of_index_t<fmindex_epr_v2_32>> kmer_cursor_table::cursor_of(
+    fmindex_epr_v2_32 const&,
+    std::span<const uint8_t> const
+) const;
+template std::optional<cursor_of_index_t<fmindex_dna4>> kmer_cursor_table::cursor_of(
+    fmindex_dna4 const&,
+    std::span<const uint8_t> const
+) const;
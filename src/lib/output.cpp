@@ -6,6 +6,8 @@
 #include <limits>
 #include <ranges>
 #include <stdexcept>
+#include <system_error>
+#include <variant>
 
 #include <cereal/archives/binary.hpp>
 #include <cereal/types/array.hpp>
@@ -22,13 +24,52 @@
 
 namespace output {
 
-void save_index(fmindex const& index, std::filesystem::path const& index_path) {
+// The file is written to a temporary file first, which is renamed at the end, such that a later run never sees a
+// partially written file. Throws if the file could not be written, the temporary file is removed in that case
+template<typename write_contents_t>
+static void write_file_through_temporary_file(
+    std::filesystem::path const& path,
+    write_contents_t&& write_contents
+) {
+    auto temporary_path = path;
+    temporary_path += ".tmp";
+
+    try {
+        {
+            auto ofs = std::ofstream(temporary_path, std::ios::binary);
+            write_contents(ofs);
+
+            ofs.close();
+            if (!ofs) {
+                throw std::runtime_error("Could not write to the file " + temporary_path.string() + ".");
+            }
+        }
+
+        std::filesystem::rename(temporary_path, path);
+    } catch (...) {
+        std::error_code ignored_error{};
+        std::filesystem::remove(temporary_path, ignored_error);
+
+        throw;
+    }
+}
+
+void save_index(
+    fmindex_variant const& index,
+    kmer_cursor_table const& kmer_table,
+    std::filesystem::path const& index_path
+) {
     spdlog::info("saving index to {}", index_path);
 
     try {
-        auto ofs     = std::ofstream(index_path, std::ios::binary);
-        auto archive = cereal::BinaryOutputArchive{ofs};
-        archive(index);
+        write_file_through_temporary_file(index_path, [&index, &kmer_table] (std::ofstream& ofs) {
+            ofs.write(index_file_marker.data(), index_file_marker.size());
+            ofs.put(static_cast<char>(occurrence_table_variant_of(index)));
+
+            auto archive = cereal::BinaryOutputArchive{ofs};
+            std::visit([&archive] (auto const& typed_index) { archive(typed_index); }, index);
+            archive(kmer_table);
+        });
     } catch (std::exception const& e) {
         spdlog::warn(
             "An error occured while trying to write the index to "
@@ -39,6 +80,53 @@ void save_index(fmindex const& index, std::filesystem::path const& index_path) {
     }
 }
 
+void save_index_shard_ranges(
+    std::vector<index_shard_range> const& shard_ranges,
+    std::filesystem::path const& index_path
+) {
+    spdlog::info("saving the ranges of {} index shards to {}", shard_ranges.size(), index_path);
+
+    try {
+        write_file_through_temporary_file(index_path, [&shard_ranges] (std::ofstream& ofs) {
+            ofs.write(index_shards_file_marker.data(), index_shards_file_marker.size());
+
+            auto archive = cereal::BinaryOutputArchive{ofs};
+            archive(shard_ranges);
+        });
+    } catch (std::exception const& e) {
+        spdlog::warn(
+            "An error occured while trying to write the index shard ranges to "
+            "the file {}.\nContinuing without saving them.\n{}\n",
+            index_path,
+            e.what()
+        );
+    }
+}
+
+void save_references(input::references const& references, std::filesystem::path const& references_path) {
+    spdlog::info("saving references to {}", references_path);
+
+    try {
+        write_file_through_temporary_file(references_path, [&references] (std::ofstream& ofs) {
+            ofs.write(input::references_file_marker.data(), input::references_file_marker.size());
+
+            auto archive = cereal::BinaryOutputArchive{ofs};
+            archive(references.records.size());
+
+            for (auto const& record : references.records) {
+                archive(record.id, record.rank_sequence);
+            }
+        });
+    } catch (std::exception const& e) {
+        spdlog::warn(
+            "An error occured while trying to write the references to "
+            "the file {}.\nContinuing without saving the references.\n{}\n",
+            references_path,
+            e.what()
+        );
+    }
+}
+
 alignment_output::alignment_output(
         std::filesystem::path const& output_path,
         std::vector<input::reference_record> const& references_
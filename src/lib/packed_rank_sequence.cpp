@@ -0,0 +1,97 @@
+#include <packed_rank_sequence.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+static bool is_packable_rank(uint8_t const rank) {
+    return rank >= 1 && rank <= 4;
+}
+
+packed_rank_sequence::packed_rank_sequence(std::span<const uint8_t> const rank_sequence)
+    : length{rank_sequence.size()},
+    words((rank_sequence.size() + characters_per_word - 1) / characters_per_word, 0) {
+    for (size_t position = 0; position < rank_sequence.size(); ++position) {
+        uint8_t const rank = rank_sequence[position];
+
+        if (is_packable_rank(rank)) {
+            words[position / characters_per_word] |=
+                static_cast<uint64_t>(rank - 1) << (2 * (position % characters_per_word));
+            continue;
+        }
+
+        if (
+            !exception_runs.empty() &&
+            exception_runs.back().rank == rank &&
+            exception_runs.back().position + exception_runs.back().length == position
+        ) {
+            ++exception_runs.back().length;
+        } else {
+            exception_runs.emplace_back(exception_run {
+                .position = position,
+                .length = 1,
+                .rank = rank
+            });
+        }
+    }
+}
+
+packed_rank_sequence::packed_rank_sequence(std::initializer_list<uint8_t> const rank_sequence)
+    : packed_rank_sequence(std::span<const uint8_t>(rank_sequence.begin(), rank_sequence.size())) {}
+
+size_t packed_rank_sequence::size() const {
+    return length;
+}
+
+size_t packed_rank_sequence::num_exception_runs() const {
+    return exception_runs.size();
+}
+
+void packed_rank_sequence::unpack_into(size_t const begin, std::span<uint8_t> const out) const {
+    assert(begin + out.size() <= length);
+
+    size_t position = begin;
+    size_t out_index = 0;
+
+    while (out_index < out.size()) {
+        size_t const word_index = position / characters_per_word;
+        size_t const first_in_word = position % characters_per_word;
+        size_t const num_from_word = std::min(characters_per_word - first_in_word, out.size() - out_index);
+
+        uint64_t word = words[word_index] >> (2 * first_in_word);
+        for (size_t i = 0; i < num_from_word; ++i) {
+            out[out_index + i] = static_cast<uint8_t>((word & 0b11) + 1);
+            word >>= 2;
+        }
+
+        position += num_from_word;
+        out_index += num_from_word;
+    }
+
+    size_t const end = begin + out.size();
+
+    // the first run that could overlap the window is the last one that starts before it
+    auto run_it = std::ranges::upper_bound(exception_runs, begin, {}, &exception_run::position);
+    if (run_it != exception_runs.begin()) {
+        --run_it;
+    }
+
+    for (; run_it != exception_runs.end() && run_it->position < end; ++run_it) {
+        size_t const overlap_begin = std::max(run_it->position, begin);
+        size_t const overlap_end = std::min(run_it->position + run_it->length, end);
+
+        if (overlap_begin < overlap_end) {
+            std::fill(
+                out.begin() + (overlap_begin - begin),
+                out.begin() + (overlap_end - begin),
+                run_it->rank
+            );
+        }
+    }
+}
+
+std::vector<uint8_t> packed_rank_sequence::unpack() const {
+    std::vector<uint8_t> rank_sequence(length);
+    unpack_into(0, rank_sequence);
+
+    return rank_sequence;
+}
@@ -8,6 +8,8 @@
 
 #include <chrono>
 #include <limits>
+#include <optional>
+#include <span>
 
 namespace parallelization {
 
@@ -46,7 +48,8 @@ void spawn_search_task(
     mutex_guarded<input::queries>& queries,
     input::references const& references,
     cli::command_line_input const& cli_input,
-    search::searcher const& searcher,
+    std::vector<search::searcher> const& searchers,
+    alignment_pass const pass,
     mutex_guarded<output::alignment_output>& alignment_output,
     mutex_guarded<statistics::search_and_alignment_statistics>& global_stats,
     BS::thread_pool& thread_pool,
@@ -57,7 +60,8 @@ void spawn_search_task(
             &queries,
             &references,
             &cli_input,
-            &searcher,
+            &searchers,
+            pass,
             &alignment_output,
             &threads_should_stop,
             &global_stats,
@@ -90,26 +94,76 @@ void spawn_search_task(
 
                 pex::pex_tree_config const pex_tree_config(query.rank_sequence.size(), cli_input);
                 pex::pex_tree const pex_tree(pex_tree_config);
+                // with the joint search, leaf i of the mirrored tree covers the reverse complement of forward leaf i
+                pex::pex_tree const pex_tree_reverse_complement = cli_input.joint_strand_search() ?
+                    pex_tree.mirrored() : pex_tree;
 
                 auto const forward_seeds = pex_tree.generate_seeds(query.rank_sequence, cli_input.seed_sampling_step_size());
-                auto const reverse_complement_seeds = pex_tree.generate_seeds(
+                auto const reverse_complement_seeds = pex_tree_reverse_complement.generate_seeds(
                     query.reverse_complement_rank_sequence,
                     cli_input.seed_sampling_step_size()
                 );
 
-                auto const forward_search_result = searcher.search_seeds(forward_seeds);
-                auto const reverse_complement_search_result = searcher.search_seeds(reverse_complement_seeds);
+                auto const search_with = [&] (search::searcher const& searcher) {
+                    return cli_input.joint_strand_search() ?
+                        searcher.search_seeds_of_both_orientations(forward_seeds, reverse_complement_seeds)
+                        : search::both_orientations_search_result {
+                            .forward = searcher.search_seeds(forward_seeds),
+                            .reverse_complement = searcher.search_seeds(reverse_complement_seeds)
+                        };
+                };
+
+                auto const [forward_search_result, reverse_complement_search_result] = [&] () {
+                    if (searchers.size() == 1) {
+                        return search_with(searchers.front());
+                    }
+
+                    std::vector<search::search_result> forward_results_of_shards{};
+                    std::vector<search::search_result> reverse_complement_results_of_shards{};
+                    for (auto const& searcher : searchers) {
+                        auto [forward, reverse_complement] = search_with(searcher);
+                        forward_results_of_shards.emplace_back(std::move(forward));
+                        reverse_complement_results_of_shards.emplace_back(std::move(reverse_complement));
+                    }
+
+                    auto const& search_config = searchers.front().config;
+
+                    return search::both_orientations_search_result {
+                        .forward = search::merge_search_results_of_shards(
+                            std::move(forward_results_of_shards),
+                            search_config
+                        ),
+                        .reverse_complement = search::merge_search_results_of_shards(
+                            std::move(reverse_complement_results_of_shards),
+                            search_config
+                        )
+                    };
+                }();
 
                 auto anchor_packages = create_anchor_packages(
                     forward_search_result, reverse_complement_search_result, cli_input
                 );
 
+                // the seeds are the same in every pass, only the searched shard differs
                 statistics::search_and_alignment_statistics local_stats(cli_input.stats_input_hint());
-                local_stats.add_query_length(query.rank_sequence.size());
-                local_stats.add_statistics_for_seeds(forward_seeds, reverse_complement_seeds);
+                if (pass.is_last_pass) {
+                    local_stats.add_query_length(query.rank_sequence.size());
+                    local_stats.add_statistics_for_seeds(forward_seeds, reverse_complement_seeds);
+                }
                 local_stats.add_statistics_for_search_result(forward_search_result, reverse_complement_search_result);
                 size_t spent_milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(stopwatch.elapsed()).count();
-                local_stats.add_milliseconds_spent_in_search_per_query(spent_milliseconds);
+                // the time of every query is recorded once, summed over all passes
+                if (pass.collected_alignments != nullptr) {
+                    auto && [collected_lock, collected_alignments] = pass.collected_alignments->lock_unique();
+                    if (pass.is_last_pass) {
+                        spent_milliseconds += collected_alignments.take_milliseconds_spent_in_search(query.internal_id);
+                    } else {
+                        collected_alignments.add_milliseconds_spent_in_search(query.internal_id, spent_milliseconds);
+                    }
+                }
+                if (pass.is_last_pass) {
+                    local_stats.add_milliseconds_spent_in_search_per_query(spent_milliseconds);
+                }
                 {
                     auto && [lock, ref] = global_stats.lock_unique();
                     ref.merge_other_into_this(local_stats);
@@ -121,7 +175,9 @@ void spawn_search_task(
                     std::move(query),
                     references,
                     std::move(pex_tree),
+                    std::move(pex_tree_reverse_complement),
                     cli_input,
+                    pass,
                     alignment_output,
                     anchor_packages.size(),
                     global_stats,
@@ -140,7 +196,8 @@ void spawn_search_task(
                     queries,
                     references,
                     cli_input,
-                    searcher,
+                    searchers,
+                    pass,
                     alignment_output,
                     global_stats,
                     thread_pool,
@@ -160,11 +217,25 @@ void spawn_search_task(
     );
 }
 
+static std::optional<verification::query_profile> create_query_profile_if_used(
+    pex::pex_tree const& pex_tree,
+    std::span<const uint8_t> const query,
+    pex::pex_verification_config const& config
+) {
+    if (config.alignment_implementation == alignment::alignment_implementation::seqan3) {
+        return std::nullopt;
+    }
+
+    return std::make_optional<verification::query_profile>(pex_tree, query);
+}
+
 shared_verification_data::shared_verification_data(
     input::query_record const query_,
     input::references const& references_,
     pex::pex_tree const pex_tree_,
+    pex::pex_tree const pex_tree_reverse_complement_,
     cli::command_line_input const& cli_input_,
+    alignment_pass const pass_,
     mutex_guarded<output::alignment_output>& alignment_output_,
     size_t const num_verification_tasks_,
     mutex_guarded<statistics::search_and_alignment_statistics>& global_stats_,
@@ -172,8 +243,15 @@ shared_verification_data::shared_verification_data(
 ) : query{std::move(query_)},
     references{references_},
     pex_tree{std::move(pex_tree_)},
+    pex_tree_reverse_complement{std::move(pex_tree_reverse_complement_)},
     cli_input(cli_input_),
     config(cli_input),
+    query_profile_forward(create_query_profile_if_used(pex_tree, query.rank_sequence, config)),
+    query_profile_reverse_complement(create_query_profile_if_used(
+        pex_tree_reverse_complement,
+        query.reverse_complement_rank_sequence,
+        config
+    )),
     verified_intervals_forward(intervals::create_thread_safe_verified_intervals(
         references.records.size(),
         config.use_interval_optimization
@@ -183,6 +261,7 @@ shared_verification_data::shared_verification_data(
         config.use_interval_optimization
     )),
     all_tasks_alignments(references.records.size()),
+    pass{pass_},
     alignment_output{alignment_output_},
     num_verification_tasks_remaining(num_verification_tasks_),
     global_stats{global_stats_},
@@ -219,6 +298,11 @@ void spawn_verification_task(
 
                 auto const& query = package.orientation == alignment::query_orientation::forward ?
                             data->query.rank_sequence : data->query.reverse_complement_rank_sequence;
+                auto const& query_profile = package.orientation == alignment::query_orientation::forward ?
+                            data->query_profile_forward : data->query_profile_reverse_complement;
+                auto const* const query_profile_ptr = query_profile.has_value() ? &query_profile.value() : nullptr;
+                auto const& pex_tree = package.orientation == alignment::query_orientation::forward ?
+                            data->pex_tree : data->pex_tree_reverse_complement;
 
                 // at some point I tried using only a local verified_intervals per thread, but this massively increased runtime
                 auto& verified_intervals_for_all_references = package.orientation == alignment::query_orientation::forward ?
@@ -227,25 +311,41 @@ void spawn_verification_task(
 
                 alignment::query_alignments this_tasks_alignments(data->references.records.size());
 
-                for (auto const anchor : package.anchors) {
-                    auto const& pex_leaf_node = data->pex_tree.get_leaves().at(anchor.pex_leaf_index);
+                // the anchors are sorted by seed (PEX leaf), such that all anchors of a seed can be verified together
+                std::span<const search::anchor_t> const anchors(package.anchors);
+                size_t anchors_of_leaf_begin = 0;
+
+                while (anchors_of_leaf_begin < anchors.size()) {
+                    size_t const pex_leaf_index = anchors[anchors_of_leaf_begin].pex_leaf_index;
+                    size_t anchors_of_leaf_end = anchors_of_leaf_begin + 1;
+                    while (
+                        anchors_of_leaf_end < anchors.size() &&
+                        anchors[anchors_of_leaf_end].pex_leaf_index == pex_leaf_index
+                    ) {
+                        ++anchors_of_leaf_end;
+                    }
 
-                    verification::query_verifier verifier {
-                        .pex_tree = data->pex_tree,
-                        .anchor = anchor,
-                        .pex_leaf_node = pex_leaf_node,
+                    verification::batched_query_verifier verifier {
+                        .pex_tree = pex_tree,
+                        .anchors = anchors.subspan(anchors_of_leaf_begin, anchors_of_leaf_end - anchors_of_leaf_begin),
+                        .pex_leaf_node = pex_tree.get_leaves().at(pex_leaf_index),
                         .query = query,
                         .orientation = package.orientation,
-                        .reference = data->references.records[anchor.reference_id],
+                        .references = data->references,
                         .kind = data->config.verification_kind,
-                        .already_verified_intervals = verified_intervals_for_all_references.at(anchor.reference_id),
+                        .verified_intervals_for_all_references = verified_intervals_for_all_references,
                         .extra_verification_ratio = data->config.extra_verification_ratio,
                         .without_cigar = data->cli_input.without_cigar(),
+                        .alignment_implementation = data->config.alignment_implementation,
                         .alignments = this_tasks_alignments,
-                        .stats = local_stats
+                        .stats = local_stats,
+                        .profile = query_profile_ptr,
+                        .incremental_verification = data->config.incremental_verification
                     };
 
                     verifier.verify();
+
+                    anchors_of_leaf_begin = anchors_of_leaf_end;
                 }
 
                 spdlog::debug("finished verifiying package {} of query {}: {}", package.package_id, data->query.internal_id, data->query.id);
@@ -257,10 +357,32 @@ void spawn_verification_task(
                     auto && [alignments_lock, all_tasks_alignments] = data->all_tasks_alignments.lock_unique();
                     all_tasks_alignments.merge_other_into_this(std::move(this_tasks_alignments));
 
+                    bool const is_last_task = data->num_verification_tasks_remaining.fetch_sub(1) == 1;
+
+                    // keep the alignments for the last pass if I am the last remaining thread of an earlier pass
+                    if (is_last_task && !data->pass.is_last_pass) {
+                        auto && [collected_lock, collected_alignments] = data->pass.collected_alignments->lock_unique();
+                        collected_alignments.add(data->query.internal_id, std::move(all_tasks_alignments));
+                        collected_alignments.add_milliseconds_spent_in_verification(
+                            data->query.internal_id,
+                            data->spent_milliseconds.load()
+                        );
+                    }
+
                     // write to output file and stats if I am the last remaining thread
-                    if (data->num_verification_tasks_remaining.fetch_sub(1) == 1) {
+                    if (is_last_task && data->pass.is_last_pass) {
+                        size_t spent_milliseconds_of_all_passes = data->spent_milliseconds.load();
+
+                        if (data->pass.collected_alignments != nullptr) {
+                            auto && [collected_lock, collected_alignments] =
+                                data->pass.collected_alignments->lock_unique();
+                            collected_alignments.move_into(data->query.internal_id, all_tasks_alignments);
+                            spent_milliseconds_of_all_passes +=
+                                collected_alignments.take_milliseconds_spent_in_verification(data->query.internal_id);
+                        }
+
                         local_stats.add_num_alignments(all_tasks_alignments.size());
-                        local_stats.add_milliseconds_spent_in_verification_per_query(data->spent_milliseconds.load());
+                        local_stats.add_milliseconds_spent_in_verification_per_query(spent_milliseconds_of_all_passes);
 
                         for (size_t reference_id = 0; reference_id < data->references.records.size(); ++reference_id) {
                             for (auto const& alignment : all_tasks_alignments.to_reference(reference_id)) {
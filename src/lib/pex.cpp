@@ -2,8 +2,10 @@
 #include <pex.hpp>
 #include <verification.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <ranges>
+#include <set>
 #include <stdexcept>
 
 #include <ivsigma/ivsigma.h>
@@ -46,7 +48,9 @@ pex_verification_config::pex_verification_config(cli::command_line_input const&
             pex::verification_kind_t::direct_full :
             pex::verification_kind_t::hierarchical
     },
-    extra_verification_ratio{cli_input.extra_verification_ratio()}
+    extra_verification_ratio{cli_input.extra_verification_ratio()},
+    alignment_implementation{alignment::alignment_implementation_from_string(cli_input.alignment_implementation())},
+    incremental_verification{cli_input.incremental_verification()}
 {}
 
 size_t pex_tree::node::length_of_query_span() const {
@@ -79,6 +83,10 @@ std::vector<pex_tree::node> const& pex_tree::get_leaves() const {
     return leaves;
 }
 
+std::vector<pex_tree::node> const& pex_tree::get_inner_nodes() const {
+    return inner_nodes;
+}
+
 // ------------------------------ PEX tree building + seeding ------------------------------
 
 pex_tree::pex_tree(pex_tree_config const config)
@@ -276,6 +284,56 @@ std::vector<search::seed> pex_tree::generate_seeds(
     return seeds;
 }
 
+pex_tree pex_tree::mirrored() const {
+    size_t const query_length = root().length_of_query_span();
+    pex_tree mirrored_tree = *this;
+
+    auto const mirror = [query_length] (node& n) {
+        size_t const query_index_from = n.query_index_from;
+        n.query_index_from = query_length - 1 - n.query_index_to;
+        n.query_index_to = query_length - 1 - query_index_from;
+    };
+
+    std::ranges::for_each(mirrored_tree.inner_nodes, mirror);
+    std::ranges::for_each(mirrored_tree.leaves, mirror);
+
+    return mirrored_tree;
+}
+
+std::vector<search::search_scheme_key> predicted_search_scheme_keys(
+    cli::command_line_input const& cli_input,
+    size_t const max_seed_length
+) {
+    // up to this length, every query length is used, after that the grid is geometric with this growth factor
+    static constexpr size_t every_query_length_up_to = 1'000;
+    static constexpr double query_length_growth_factor = 1.01;
+
+    std::set<search::search_scheme_key> keys{};
+
+    for (
+        size_t query_length = 1;
+        query_length <= input::queries::MAX_ALLOWED_QUERY_LENGTH;
+        query_length = query_length < every_query_length_up_to ?
+            query_length + 1 :
+            static_cast<size_t>(static_cast<double>(query_length) * query_length_growth_factor)
+    ) {
+        // these queries are skipped by the input
+        if (!input::num_errors_fit_query_length(query_length, cli_input)) {
+            continue;
+        }
+
+        pex_tree const tree(pex_tree_config(query_length, cli_input));
+
+        for (auto const& leaf : tree.get_leaves()) {
+            if (leaf.length_of_query_span() <= max_seed_length) {
+                keys.emplace(leaf.length_of_query_span(), leaf.num_errors);
+            }
+        }
+    }
+
+    return std::vector<search::search_scheme_key>(keys.begin(), keys.end());
+}
+
 // ------------------------------ DOT export ------------------------------
 
 std::string pex_tree::node::dot_statement(size_t const id) const {
@@ -1,12 +1,16 @@
 #include <fmindex.hpp>
+#include <interleaved_search.hpp>
 #include <search.hpp>
 
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <functional>
 #include <limits>
 #include <ranges>
 #include <set>
+#include <tuple>
+#include <variant>
 
 #include <fmindex-collection/search/SearchNg21.h>
 #include <search_schemes/generator/optimum.h>
@@ -140,57 +144,174 @@ void search_result::append_anchor_packages(
     }
 }
 
-search_result searcher::search_seeds(
-    std::vector<seed> const& seeds
-) const {
-    using namespace internal;
+namespace internal {
 
-    std::vector<search_result::anchors_of_seed> anchors_by_seed{};
-    size_t num_fully_excluded_seeds = 0;
+// the search of a single shard only knows the anchors of this shard, so the caps are applied again to the anchors
+// of the seed in all shards
+static void apply_caps_to_anchors_of_shards(
+    search_result::anchors_of_seed& anchors_of_seed,
+    bool const is_excluded_in_some_shard,
+    search_config const& config
+) {
+    // the searches of the shards only report the number of distinct anchors of seeds that are not excluded
+    size_t const num_distinct_anchors = anchors_of_seed.num_kept_raw_anchors +
+        anchors_of_seed.num_excluded_raw_anchors_by_soft_cap;
+
+    if (
+        config.anchor_choice_strategy != anchor_choice_strategy_t::first_reported &&
+        (is_excluded_in_some_shard || num_distinct_anchors > config.max_num_anchors_hard)
+    ) {
+        anchors_of_seed = search_result::anchors_of_seed{
+            .num_kept_useful_anchors = 0,
+            .num_kept_raw_anchors = 0,
+            .num_excluded_raw_anchors_by_soft_cap = 0,
+            .anchors_by_reference{}
+        };
 
-    auto const seeds_span = std::span(seeds);
-    // this scheme cache exists, because the seeds are not necessarily the same length.
-    // the creation of the expanded search scheme in not completely free, therefore we
-    // want to reuse them as much as possible. But to be honest, this likely doesn't really
-    // matter for the running time of the whole program.
-    internal::search_scheme_cache scheme_cache;
+        return;
+    }
 
-    for (size_t seed_index = 0; seed_index < seeds.size(); ++seed_index) {
-        auto const& seed = seeds[seed_index];
-        auto const& search_scheme = scheme_cache.get(
-            seed.sequence.size(),
-            seed.num_errors
-        );
+    // the kept anchors are a subset of the kept raw anchors
+    if (anchors_of_seed.num_kept_raw_anchors <= config.max_num_anchors_soft) {
+        return;
+    }
 
-        // wrapper for the search interface that expects a range
-        auto const seed_single_span = seeds_span.subspan(seed_index, 1)
-            | std::views::transform(&search::seed::sequence);
+    anchors_t anchors{};
+    for (auto const& anchors_of_reference : anchors_of_seed.anchors_by_reference) {
+        anchors.insert(anchors.end(), anchors_of_reference.begin(), anchors_of_reference.end());
+    }
 
-        std::vector<anchor_group> anchor_groups{};
-        size_t total_num_raw_anchors = 0;
+    // many raw anchors can be left after erasing the useless ones, then nothing is removed here
+    if (anchors.size() <= config.max_num_anchors_soft) {
+        return;
+    }
 
-        // search_n here searches at most max_num_anchors_hard many anchors
-        fmindex_collection::search_ng21::search_n(
-            index,
-            seed_single_span,
-            search_scheme,
-            config.anchor_choice_strategy == anchor_choice_strategy_t::first_reported ?
-                config.max_num_anchors_soft
-                : std::max(config.max_num_anchors_hard, config.max_num_anchors_hard + 1),
-            [&anchor_groups, &total_num_raw_anchors] (
-                [[maybe_unused]] size_t const _seed_index_in_wrapper_range,
-                auto cursor,
-                size_t const errors
-            ) {
-                total_num_raw_anchors += cursor.count();
-                anchor_groups.emplace_back(cursor, errors);
+    size_t const num_removed_anchors = anchors.size() - config.max_num_anchors_soft;
+    anchors_of_seed.num_excluded_raw_anchors_by_soft_cap += num_removed_anchors;
+    anchors_of_seed.num_kept_raw_anchors -= num_removed_anchors;
+
+    std::ranges::stable_sort(anchors, [] (anchor_t const& anchor1, anchor_t const& anchor2) {
+        return anchor1.num_errors < anchor2.num_errors;
+    });
+    anchors.resize(config.max_num_anchors_soft);
+    anchors_of_seed.num_kept_useful_anchors = anchors.size();
+
+    for (auto& anchors_of_reference : anchors_of_seed.anchors_by_reference) {
+        anchors_of_reference.clear();
+    }
+
+    // the anchors of every reference stay sorted by position, like after erase_useless_anchors
+    std::ranges::sort(anchors, [] (anchor_t const& anchor1, anchor_t const& anchor2) {
+        return std::tie(anchor1.reference_id, anchor1.reference_position) <
+            std::tie(anchor2.reference_id, anchor2.reference_position);
+    });
+    for (auto const& anchor : anchors) {
+        anchors_of_seed.anchors_by_reference[anchor.reference_id].push_back(anchor);
+    }
+}
+
+} // namespace internal
+
+search_result merge_search_results_of_shards(
+    std::vector<search_result> results_of_shards,
+    search_config const& config
+) {
+    assert(!results_of_shards.empty());
+
+    search_result merged = std::move(results_of_shards.front());
+    merged.num_fully_excluded_seeds = 0;
+
+    for (size_t seed_index = 0; seed_index < merged.anchors_by_seed.size(); ++seed_index) {
+        auto& merged_anchors_of_seed = merged.anchors_by_seed[seed_index];
+        bool is_excluded_in_some_shard = merged_anchors_of_seed.anchors_by_reference.empty();
+
+        for (size_t shard_id = 1; shard_id < results_of_shards.size(); ++shard_id) {
+            auto& anchors_of_seed = results_of_shards[shard_id].anchors_by_seed[seed_index];
+
+            merged_anchors_of_seed.num_kept_useful_anchors += anchors_of_seed.num_kept_useful_anchors;
+            merged_anchors_of_seed.num_kept_raw_anchors += anchors_of_seed.num_kept_raw_anchors;
+            merged_anchors_of_seed.num_excluded_raw_anchors_by_soft_cap +=
+                anchors_of_seed.num_excluded_raw_anchors_by_soft_cap;
+
+            // fully excluded in this shard
+            if (anchors_of_seed.anchors_by_reference.empty()) {
+                is_excluded_in_some_shard = true;
+                continue;
             }
-        );
+
+            if (merged_anchors_of_seed.anchors_by_reference.empty()) {
+                merged_anchors_of_seed.anchors_by_reference = std::move(anchors_of_seed.anchors_by_reference);
+                continue;
+            }
+
+            assert(merged_anchors_of_seed.anchors_by_reference.size() == anchors_of_seed.anchors_by_reference.size());
+
+            for (size_t reference_id = 0; reference_id < anchors_of_seed.anchors_by_reference.size(); ++reference_id) {
+                auto& anchors = anchors_of_seed.anchors_by_reference[reference_id];
+                if (anchors.empty()) {
+                    continue;
+                }
+
+                // the shards cover disjoint references, so at most one of them has anchors here
+                assert(merged_anchors_of_seed.anchors_by_reference[reference_id].empty());
+                merged_anchors_of_seed.anchors_by_reference[reference_id] = std::move(anchors);
+            }
+        }
+
+        internal::apply_caps_to_anchors_of_shards(merged_anchors_of_seed, is_excluded_in_some_shard, config);
+
+        if (merged_anchors_of_seed.anchors_by_reference.empty()) {
+            ++merged.num_fully_excluded_seeds;
+        }
+    }
+
+    return merged;
+}
+
+namespace internal {
+
+// The searches stop as soon as the seed is known to exceed the hard cap (or has enough anchors for
+// first_reported). The interleaved search stops as soon as the summed counts of the reported cursors reach this
+// limit, also in the middle of a search of the scheme. The search_n path checks it between the searches of the scheme
+static size_t max_num_raw_anchors_per_seed(search_config const& config) {
+    return config.anchor_choice_strategy == anchor_choice_strategy_t::first_reported ?
+        config.max_num_anchors_soft
+        : std::max(config.max_num_anchors_hard, config.max_num_anchors_hard + 1);
+}
+
+static std::vector<search_schemes::Scheme const*> search_schemes_of(
+    search_scheme_cache& scheme_cache,
+    std::vector<seed> const& seeds
+) {
+    std::vector<search_schemes::Scheme const*> search_schemes_of_seeds{};
+    search_schemes_of_seeds.reserve(seeds.size());
+    for (auto const& seed : seeds) {
+        search_schemes_of_seeds.push_back(&scheme_cache.get(seed.sequence.size(), seed.num_errors));
+    }
+
+    return search_schemes_of_seeds;
+}
+
+// applies the caps and the anchor choice strategy to the search results and locates the chosen anchors
+static search_result anchors_of_search_results(
+    searcher const& s,
+    std::vector<seed> const& seeds,
+    std::vector<interleaved_search::seed_search_result> search_results_of_seeds
+) {
+    auto const& config = s.config;
+
+    std::vector<search_result::anchors_of_seed> anchors_by_seed{};
+    size_t num_fully_excluded_seeds = 0;
+
+    for (size_t seed_index = 0; seed_index < seeds.size(); ++seed_index) {
+        auto const& seed = seeds[seed_index];
+        auto& [anchor_groups, total_num_raw_anchors] = search_results_of_seeds[seed_index];
 
         if (
             total_num_raw_anchors > config.max_num_anchors_hard
             && config.anchor_choice_strategy != anchor_choice_strategy_t::first_reported
         ) {
+            ++num_fully_excluded_seeds;
             anchors_by_seed.emplace_back(search_result::anchors_of_seed{
                 .num_kept_useful_anchors = 0,
                 .num_kept_raw_anchors = 0,
@@ -201,11 +322,21 @@ search_result searcher::search_seeds(
             continue;
         }
 
+        // the suffix array intervals of the groups often overlap, e.g. when an occurrence with 1 error is
+        // also reported as one with 2 errors. The hard cap above still uses the raw count, because search_n
+        // stops reporting based on it. The selection below runs on the distinct rows
+        anchor_groups = merge_overlapping_anchor_groups(std::move(anchor_groups));
+
+        size_t total_num_distinct_anchors = 0;
+        for (auto const& group : anchor_groups) {
+            total_num_distinct_anchors += group.count();
+        }
+
         switch (config.anchor_group_order) {
             case anchor_group_order_t::count_first:
                 std::ranges::sort(anchor_groups, [] (anchor_group const& group1, anchor_group const& group2) {
-                    if (group1.cursor.count() != group2.cursor.count()) {
-                        return group1.cursor.count() < group2.cursor.count();
+                    if (group1.count() != group2.count()) {
+                        return group1.count() < group2.count();
                     } else {
                         return group1.num_errors < group2.num_errors;
                     }
@@ -215,7 +346,7 @@ search_result searcher::search_seeds(
             case anchor_group_order_t::num_errors_first:
                 std::ranges::sort(anchor_groups, [] (anchor_group const& group1, anchor_group const& group2) {
                     if (group1.num_errors != group2.num_errors) {
-                        return group1.cursor.count() < group2.cursor.count();
+                        return group1.count() < group2.count();
                     } else {
                         return group1.num_errors < group2.num_errors;
                     }
@@ -228,13 +359,14 @@ search_result searcher::search_seeds(
                 throw std::runtime_error("(Should be unreachable) internal bug in anchor group order config.");
         }
 
-        // At some point in the future, if the locate operation start showing up in profiles,
-        // it could be an optimization opportunity to merge the fmindex cursors before locating
-
         size_t num_kept_raw_anchors = 0;
-        std::vector<anchors_t> anchors_by_reference(num_reference_sequences);
         size_t anchor_group_index = 0;
 
+        // the rows are only selected here and located together afterwards, such that the locate walks
+        // can be interleaved
+        std::vector<size_t> selected_rows{};
+        std::vector<size_t> selected_num_errors{};
+
         // switch case didn't work here, not sure why
         if (config.anchor_choice_strategy == anchor_choice_strategy_t::round_robin) {
             // this is a somewhat complicated implementation using std::set to make sure that
@@ -248,20 +380,15 @@ search_result searcher::search_seeds(
                 num_kept_raw_anchors != config.max_num_anchors_soft &&
                 !remaining_group_indices.empty()
             ) {
-                auto const& [cursor, num_errors] = anchor_groups[*remaining_group_indices_iter];
-                // this assumes that cursors are not empty in the beginning
-                auto const [reference_id, position] = index.locate(cursor.lb + round);
-                anchors_by_reference[reference_id].emplace_back(anchor_t {
-                    .pex_leaf_index = seed.pex_leaf_index,
-                    .reference_id = reference_id,
-                    .reference_position = position,
-                    .num_errors = num_errors
-                });
+                auto const& group = anchor_groups[*remaining_group_indices_iter];
+                // this assumes that groups are not empty in the beginning
+                selected_rows.push_back(group.suffix_array_begin + round);
+                selected_num_errors.push_back(group.num_errors);
                 ++num_kept_raw_anchors;
 
                 auto previous_iter = remaining_group_indices_iter;
                 ++remaining_group_indices_iter;
-                if (cursor.len == round + 1) {
+                if (group.count() == round + 1) {
                     remaining_group_indices.erase(previous_iter);
                 }
 
@@ -278,16 +405,11 @@ search_result searcher::search_seeds(
                 num_kept_raw_anchors != config.max_num_anchors_soft &&
                 anchor_group_index < anchor_groups.size()
             ) {
-                auto const& [cursor, num_errors] = anchor_groups[anchor_group_index];
+                auto const& group = anchor_groups[anchor_group_index];
 
-                for (auto const& anchor: cursor) {
-                    auto const [reference_id, position] = index.locate(anchor);
-                    anchors_by_reference[reference_id].emplace_back(anchor_t {
-                        .pex_leaf_index = seed.pex_leaf_index,
-                        .reference_id = reference_id,
-                        .reference_position = position,
-                        .num_errors = num_errors
-                    });
+                for (size_t row = group.suffix_array_begin; row < group.suffix_array_end; ++row) {
+                    selected_rows.push_back(row);
+                    selected_num_errors.push_back(group.num_errors);
 
                     ++num_kept_raw_anchors;
                     if (num_kept_raw_anchors == config.max_num_anchors_soft) {
@@ -301,7 +423,21 @@ search_result searcher::search_seeds(
             throw std::runtime_error("(Should be unreachable) internal bug in anchor choice strategy config.");
         }
 
-        size_t const num_excluded_raw_anchors_by_soft_cap = total_num_raw_anchors - num_kept_raw_anchors;
+        auto const locate_results = locate_batch(s.index, selected_rows);
+
+        std::vector<anchors_t> anchors_by_reference(s.num_reference_sequences);
+        for (size_t i = 0; i < locate_results.size(); ++i) {
+            auto const [reference_id_in_index, position] = locate_results[i];
+            size_t const reference_id = s.first_reference_id + reference_id_in_index;
+            anchors_by_reference[reference_id].emplace_back(anchor_t {
+                .pex_leaf_index = seed.pex_leaf_index,
+                .reference_id = reference_id,
+                .reference_position = position,
+                .num_errors = selected_num_errors[i]
+            });
+        }
+
+        size_t const num_excluded_raw_anchors_by_soft_cap = total_num_distinct_anchors - num_kept_raw_anchors;
 
         size_t num_kept_useful_anchors = num_kept_raw_anchors;
 
@@ -323,32 +459,258 @@ search_result searcher::search_seeds(
     };
 }
 
-namespace internal {
+// the search_n of fmindex-collection or the interleaved search, for the type of the occurrence table of the index
+template<typename index_t>
+static std::vector<interleaved_search::seed_search_result> search_seeds_in_index(
+    index_t const& index,
+    kmer_cursor_table const& kmer_table,
+    bool const interleaved_seed_search,
+    std::vector<seed> const& seeds,
+    std::span<search_schemes::Scheme const* const> const search_schemes_of_seeds,
+    size_t const max_num_raw_anchors_per_seed
+) {
+    if (interleaved_seed_search) {
+        return interleaved_search::search_seeds(
+            index,
+            kmer_table,
+            seeds,
+            search_schemes_of_seeds,
+            max_num_raw_anchors_per_seed
+        );
+    }
+
+    std::vector<interleaved_search::seed_search_result> search_results_of_seeds{};
+    auto const seeds_span = std::span(seeds);
+    search_schemes::Scheme single_search_scheme(1);
+
+    for (size_t seed_index = 0; seed_index < seeds.size(); ++seed_index) {
+        // wrapper for the search interface that expects a range
+        auto const seed_single_span = seeds_span.subspan(seed_index, 1)
+            | std::views::transform(&search::seed::sequence);
+
+        auto& result = search_results_of_seeds.emplace_back(interleaved_search::seed_search_result {
+            .anchor_groups{},
+            .total_num_raw_anchors = 0
+        });
+
+        // e.g. the DNA4 index has no rank for N, which search_n can't handle
+        if (!is_in_alphabet_of_index<index_t>(seeds[seed_index].sequence)) {
+            continue;
+        }
+
+        // search_n has no way to stop the search from its delegate, so it is called once for every search of the
+        // scheme and the count is checked in between. The remaining searches of a repetitive seed, which could only
+        // report anchors that are dropped by the hard cap anyway, are skipped. Within a single search, the limit
+        // given to search_n is the only one, so the count can overshoot the limit by the cursors of that search
+        for (auto const& search : *search_schemes_of_seeds[seed_index]) {
+            if (result.total_num_raw_anchors >= max_num_raw_anchors_per_seed) {
+                break;
+            }
+
+            // the assignment reuses the memory of the previous search
+            single_search_scheme.front() = search;
+
+            fmindex_collection::search_ng21::search_n(
+                index,
+                seed_single_span,
+                single_search_scheme,
+                max_num_raw_anchors_per_seed - result.total_num_raw_anchors,
+                [&result] (
+                    [[maybe_unused]] size_t const _seed_index_in_wrapper_range,
+                    auto cursor,
+                    size_t const errors
+                ) {
+                    result.total_num_raw_anchors += cursor.count();
+                    result.anchor_groups.emplace_back(cursor.lb, cursor.lb + cursor.count(), errors);
+                }
+            );
+        }
+    }
+
+    return search_results_of_seeds;
+}
+
+} // namespace internal
+
+search_result searcher::search_seeds(
+    std::vector<seed> const& seeds
+) const {
+    using namespace internal;
+
+    size_t const max_num_raw_anchors_per_seed = internal::max_num_raw_anchors_per_seed(config);
+    auto const search_schemes_of_seeds = search_schemes_of(scheme_cache, seeds);
+
+    auto search_results_of_seeds = std::visit([&] (auto const& typed_index) {
+        return search_seeds_in_index(
+            typed_index,
+            kmer_table,
+            config.interleaved_seed_search,
+            seeds,
+            search_schemes_of_seeds,
+            max_num_raw_anchors_per_seed
+        );
+    }, index);
+
+    return anchors_of_search_results(*this, seeds, std::move(search_results_of_seeds));
+}
+
+both_orientations_search_result searcher::search_seeds_of_both_orientations(
+    std::vector<seed> const& forward_seeds,
+    std::vector<seed> const& reverse_complement_seeds
+) const {
+    using namespace internal;
+
+    if (!config.interleaved_seed_search) {
+        return both_orientations_search_result {
+            .forward = search_seeds(forward_seeds),
+            .reverse_complement = search_seeds(reverse_complement_seeds)
+        };
+    }
+
+    assert(forward_seeds.size() == reverse_complement_seeds.size());
+
+    auto const search_schemes_of_seeds = search_schemes_of(scheme_cache, forward_seeds);
+
+    auto results = std::visit([&] (auto const& typed_index) {
+        return interleaved_search::search_seeds_of_both_orientations(
+            typed_index,
+            kmer_table,
+            forward_seeds,
+            search_schemes_of_seeds,
+            internal::max_num_raw_anchors_per_seed(config)
+        );
+    }, index);
+
+    return both_orientations_search_result {
+        .forward = anchors_of_search_results(*this, forward_seeds, std::move(results.forward)),
+        .reverse_complement = anchors_of_search_results(
+            *this,
+            reverse_complement_seeds,
+            std::move(results.reverse_complement)
+        )
+    };
+}
+
+// the seeds are not necessarily the same length and the creation of the expanded search schemes is not free
+// (especially with h2 for more than 3 errors), therefore they are reused by all searches
+void search_scheme_cache::prewarm(std::span<const search_scheme_key> const keys) {
+    for (auto const& key : keys) {
+        if (!prewarmed_schemes.contains(key)) {
+            auto const [pex_leaf_query_length, pex_leaf_num_errors] = key;
+            prewarmed_schemes.emplace(key, internal::create_search_scheme(pex_leaf_query_length, pex_leaf_num_errors));
+        }
+    }
+}
 
 search_schemes::Scheme const& search_scheme_cache::get(
     size_t const pex_leaf_query_length,
     size_t const pex_leaf_num_errors
 ) {
-    auto const scheme_data = std::make_tuple(pex_leaf_query_length, pex_leaf_num_errors);
-    auto const iter = schemes.find(scheme_data);
-
-    if (iter == schemes.end()) {
-        auto search_scheme = search_schemes::expand(
-            (pex_leaf_num_errors <= 3) ?
-                search_schemes::generator::optimum(0, pex_leaf_num_errors) :
-                // h2 = heuristic 2, the best heuristic search scheme generator,
-                // because the optima are not known for more than 3 errors
-                search_schemes::generator::h2(pex_leaf_num_errors + 2, 0, pex_leaf_num_errors),
-            pex_leaf_query_length
-        );
+    auto const key = std::make_tuple(pex_leaf_query_length, pex_leaf_num_errors);
 
-        auto const [emplaced_iter, _] = schemes.emplace(scheme_data, std::move(search_scheme));
-        return emplaced_iter->second;
+    // prewarmed_schemes is not modified anymore, so it can be read without locking
+    if (auto const iter = prewarmed_schemes.find(key); iter != prewarmed_schemes.end()) {
+        return iter->second;
     }
 
+    {
+        auto && [lock, schemes] = schemes_created_on_demand.lock_shared();
+        if (auto const iter = schemes.find(key); iter != schemes.end()) {
+            return iter->second;
+        }
+    }
+
+    // created outside of the lock, if two threads race here, the scheme of the first one is kept
+    auto search_scheme = internal::create_search_scheme(pex_leaf_query_length, pex_leaf_num_errors);
+
+    auto && [lock, schemes] = schemes_created_on_demand.lock_unique();
+    auto const [iter, _] = schemes.emplace(key, std::move(search_scheme));
+
+    // the references stay valid, because the nodes of an std::unordered_map are never moved
     return iter->second;
 }
 
+size_t search_scheme_cache::num_prewarmed_schemes() const {
+    return prewarmed_schemes.size();
+}
+
+namespace internal {
+
+search_schemes::Scheme create_search_scheme(size_t const pex_leaf_query_length, size_t const pex_leaf_num_errors) {
+    return search_schemes::expand(
+        (pex_leaf_num_errors <= 3) ?
+            search_schemes::generator::optimum(0, pex_leaf_num_errors) :
+            // h2 = heuristic 2, the best heuristic search scheme generator,
+            // because the optima are not known for more than 3 errors
+            search_schemes::generator::h2(pex_leaf_num_errors + 2, 0, pex_leaf_num_errors),
+        pex_leaf_query_length
+    );
+}
+
+size_t anchor_group::count() const {
+    return suffix_array_end - suffix_array_begin;
+}
+
+std::vector<anchor_group> merge_overlapping_anchor_groups(std::vector<anchor_group> anchor_groups) {
+    if (anchor_groups.size() <= 1) {
+        return anchor_groups;
+    }
+
+    struct boundary {
+        size_t position;
+        bool is_begin;
+        size_t num_errors;
+    };
+
+    std::vector<boundary> boundaries{};
+    boundaries.reserve(2 * anchor_groups.size());
+    for (auto const& group : anchor_groups) {
+        if (group.count() > 0) {
+            boundaries.emplace_back(group.suffix_array_begin, true, group.num_errors);
+            boundaries.emplace_back(group.suffix_array_end, false, group.num_errors);
+        }
+    }
+
+    std::ranges::sort(boundaries, [] (boundary const& lhs, boundary const& rhs) {
+        return lhs.position < rhs.position;
+    });
+
+    // sweep over the suffix array and keep track of the number of errors of the groups that contain the current row
+    std::multiset<size_t> num_errors_of_open_groups{};
+    std::vector<anchor_group> merged_groups{};
+    size_t segment_begin = 0;
+
+    for (size_t i = 0; i < boundaries.size();) {
+        size_t const position = boundaries[i].position;
+
+        if (!num_errors_of_open_groups.empty() && segment_begin < position) {
+            size_t const num_errors = *num_errors_of_open_groups.begin();
+
+            if (
+                !merged_groups.empty() &&
+                merged_groups.back().suffix_array_end == segment_begin &&
+                merged_groups.back().num_errors == num_errors
+            ) {
+                merged_groups.back().suffix_array_end = position;
+            } else {
+                merged_groups.emplace_back(segment_begin, position, num_errors);
+            }
+        }
+
+        for (; i < boundaries.size() && boundaries[i].position == position; ++i) {
+            if (boundaries[i].is_begin) {
+                num_errors_of_open_groups.insert(boundaries[i].num_errors);
+            } else {
+                num_errors_of_open_groups.erase(num_errors_of_open_groups.find(boundaries[i].num_errors));
+            }
+        }
+
+        segment_begin = position;
+    }
+
+    return merged_groups;
+}
+
 size_t erase_useless_anchors(std::vector<anchors_t>& anchors_by_reference) {
     size_t num_kept_useful_anchors = 0;
 
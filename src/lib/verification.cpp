@@ -1,10 +1,41 @@
+#include <bit_parallel_alignment.hpp>
 #include <math.hpp>
 #include <verification.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <span>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace verification {
 
+query_profile::query_profile(pex::pex_tree const& pex_tree, std::span<const uint8_t> const query)
+    : reverse_root_pattern_(std::vector<uint8_t>(query.rbegin(), query.rend())) {
+    add_pattern_of(pex_tree.root(), query);
+
+    for (auto const& pex_node : pex_tree.get_inner_nodes()) {
+        add_pattern_of(pex_node, query);
+    }
+}
+
+bit_parallel_alignment::query_pattern const& query_profile::pattern_of(pex::pex_tree::node const& pex_node) const {
+    return patterns.at(std::make_tuple(pex_node.query_index_from, pex_node.query_index_to));
+}
+
+bit_parallel_alignment::query_pattern const& query_profile::reverse_root_pattern() const {
+    return reverse_root_pattern_;
+}
+
+void query_profile::add_pattern_of(pex::pex_tree::node const& pex_node, std::span<const uint8_t> const query) {
+    patterns.try_emplace(
+        std::make_tuple(pex_node.query_index_from, pex_node.query_index_to),
+        query.subspan(pex_node.query_index_from, pex_node.length_of_query_span())
+    );
+}
+
 void query_verifier::verify() {
     switch (kind) {
         case pex::verification_kind_t::direct_full:
@@ -33,6 +64,8 @@ void query_verifier::direct_full_verification() {
         query,
         orientation,
         without_cigar,
+        alignment_implementation,
+        profile,
         alignments,
         stats
     );
@@ -57,6 +90,8 @@ void query_verifier::hierarchical_verification() {
             query,
             orientation,
             without_cigar,
+            alignment_implementation,
+            profile,
             alignments,
             stats
         );
@@ -70,50 +105,85 @@ void query_verifier::hierarchical_verification() {
         return;
     }
 
-    size_t const seed_query_index_from = pex_leaf_node.query_index_from;
     auto curr_pex_node = pex_tree.get_parent_of_child(pex_leaf_node);
+    std::optional<internal::verified_child> verified_child = std::nullopt;
 
     while (true) {
-        auto const reference_span_config = internal::compute_reference_span_start_and_length(
-            anchor,
-            curr_pex_node,
-            seed_query_index_from,
-            reference.rank_sequence.size(),
-            curr_pex_node.is_root() ? extra_verification_ratio : 0.0
-        );
+        auto const outcome = verify_node_of_hierarchy(curr_pex_node, verified_child);
 
-        static constexpr size_t MAX_REF_SPAN_LENGTH_WITHOUT_CHECKING_INTERVALS = 512;
-        // we ask again, because another thread might have done it
-        // this is only done when the reference span is not super small
         if (
-            reference_span_config.length > MAX_REF_SPAN_LENGTH_WITHOUT_CHECKING_INTERVALS
-            && root_was_already_verified()
+            !outcome.has_value() ||
+            *outcome == alignment::alignment_outcome::no_adequate_alignment_exists ||
+            curr_pex_node.is_root()
         ) {
-            return;
+            break;
         }
 
-        auto const outcome = internal::try_to_align_pex_node_query_with_reference_span(
-            curr_pex_node,
+        curr_pex_node = pex_tree.get_parent_of_child(curr_pex_node);
+    }
+}
+
+std::optional<alignment::alignment_outcome> query_verifier::verify_node_of_hierarchy(
+    pex::pex_tree::node const& pex_node,
+    std::optional<internal::verified_child>& verified_child
+) {
+    auto const reference_span_config = compute_reference_span_config_of(pex_node, verified_child);
+
+    // we ask again, because another thread might have done it
+    // this is only done when the reference span is not super small
+    if (
+        reference_span_config.length > internal::max_reference_span_length_without_checking_intervals
+        && root_was_already_verified()
+    ) {
+        return std::nullopt;
+    }
+
+    if (uses_incremental_verification() && !pex_node.is_root()) {
+        auto const end_range = internal::compute_end_range_of_pex_node_query_in_reference_span(
+            pex_node,
             reference,
             reference_span_config,
             query,
-            orientation,
-            without_cigar,
-            alignments,
+            profile,
             stats
         );
 
-        if (curr_pex_node.is_root()) {
-            auto && [lock, verified_intervals] = already_verified_intervals.lock_unique();
-            verified_intervals.insert(reference_span_config.as_half_open_interval());
+        if (!end_range.has_value()) {
+            return alignment::alignment_outcome::no_adequate_alignment_exists;
         }
 
-        if (outcome == alignment::alignment_outcome::no_adequate_alignment_exists || curr_pex_node.is_root()) {
-            break;
-        }
+        verified_child.emplace(internal::verified_child {
+            .pex_node = pex_node,
+            .end_range = *end_range
+        });
 
-        curr_pex_node = pex_tree.get_parent_of_child(curr_pex_node);
+        return alignment::alignment_outcome::alignment_exists;
     }
+
+    auto const outcome = internal::try_to_align_pex_node_query_with_reference_span(
+        pex_node,
+        reference,
+        reference_span_config,
+        query,
+        orientation,
+        without_cigar,
+        alignment_implementation,
+        profile,
+        alignments,
+        stats
+    );
+
+    if (pex_node.is_root()) {
+        auto && [lock, verified_intervals] = already_verified_intervals.lock_unique();
+        verified_intervals.insert(reference_span_config.as_half_open_interval());
+    }
+
+    return outcome;
+}
+
+bool query_verifier::uses_incremental_verification() const {
+    // the end ranges are only computed by the bit-parallel kernel
+    return incremental_verification && alignment::uses_bit_parallel_kernel(alignment_implementation);
 }
 
 bool query_verifier::root_was_already_verified() const {
@@ -136,13 +206,180 @@ bool query_verifier::root_was_already_verified() const {
 }
 
 internal::span_config query_verifier::compute_root_reference_span_config() const {
-    return internal::compute_reference_span_start_and_length(
+    return compute_reference_span_config_of(pex_tree.root(), std::nullopt);
+}
+
+internal::span_config query_verifier::compute_reference_span_config_of(
+    pex::pex_tree::node const& pex_node,
+    std::optional<internal::verified_child> const& verified_child
+) const {
+    auto const reference_span_config = internal::compute_reference_span_start_and_length(
         anchor,
-        pex_tree.root(),
+        pex_node,
         pex_leaf_node.query_index_from,
         reference.rank_sequence.size(),
-        extra_verification_ratio
+        pex_node.is_root() ? extra_verification_ratio : 0.0
     );
+
+    if (!verified_child.has_value()) {
+        return reference_span_config;
+    }
+
+    return internal::narrow_reference_span_to_verified_child(reference_span_config, pex_node, *verified_child);
+}
+
+void batched_query_verifier::verify() {
+    if (
+        kind != pex::verification_kind_t::hierarchical ||
+        !alignment::uses_bit_parallel_kernel(alignment_implementation) ||
+        pex_leaf_node.is_root()
+    ) {
+        for (auto const& anchor : anchors) {
+            verifier_for(anchor).verify();
+        }
+
+        return;
+    }
+
+    // the state of the hierarchical verification of every anchor is the PEX node that is currently verified
+    // and, in the incremental verification, the verified child. The node is the same for all anchors,
+    // so only the anchors that are still waiting for the verification are stored
+    std::vector<query_verifier> waiting_verifiers{};
+    std::vector<std::optional<internal::verified_child>> verified_children{};
+    for (auto const& anchor : anchors) {
+        auto verifier = verifier_for(anchor);
+        if (!verifier.root_was_already_verified()) {
+            waiting_verifiers.emplace_back(std::move(verifier));
+            verified_children.emplace_back(std::nullopt);
+        }
+    }
+
+    auto curr_pex_node = pex_tree.get_parent_of_child(pex_leaf_node);
+
+    while (!curr_pex_node.is_root() && !waiting_verifiers.empty()) {
+        std::vector<query_verifier> verifiers_of_this_node{};
+        std::vector<size_t> reference_span_offsets{};
+        std::vector<size_t> reference_span_lengths{};
+
+        for (size_t i = 0; i < waiting_verifiers.size(); ++i) {
+            auto& verifier = waiting_verifiers[i];
+            auto const reference_span_config = verifier.compute_reference_span_config_of(
+                curr_pex_node,
+                verified_children[i]
+            );
+
+            // same as in the hierarchical verification of a single anchor
+            if (
+                reference_span_config.length > internal::max_reference_span_length_without_checking_intervals
+                && verifier.root_was_already_verified()
+            ) {
+                continue;
+            }
+
+            reference_span_offsets.emplace_back(reference_span_config.offset);
+            reference_span_lengths.emplace_back(reference_span_config.length);
+            verifiers_of_this_node.emplace_back(std::move(verifier));
+
+            stats.add_reference_span_size_aligned_inner_node(reference_span_config.length);
+        }
+
+        // all reference spans of this node are unpacked next to each other into the scratch buffer of this thread
+        thread_local std::vector<uint8_t> reference_spans_scratch{};
+        reference_spans_scratch.resize(std::accumulate(reference_span_lengths.begin(), reference_span_lengths.end(), size_t{0}));
+
+        std::vector<std::span<const uint8_t>> reference_subspans{};
+        size_t scratch_offset = 0;
+        for (size_t i = 0; i < verifiers_of_this_node.size(); ++i) {
+            auto const scratch_span = std::span<uint8_t>(reference_spans_scratch).subspan(
+                scratch_offset,
+                reference_span_lengths[i]
+            );
+            verifiers_of_this_node[i].reference.rank_sequence.unpack_into(reference_span_offsets[i], scratch_span);
+            reference_subspans.emplace_back(scratch_span);
+
+            scratch_offset += reference_span_lengths[i];
+        }
+
+        std::optional<bit_parallel_alignment::query_pattern> computed_pattern;
+        if (profile == nullptr) {
+            computed_pattern.emplace(
+                query.subspan(curr_pex_node.query_index_from, curr_pex_node.length_of_query_span())
+            );
+        }
+
+        auto const& pattern = profile != nullptr ? profile->pattern_of(curr_pex_node) : *computed_pattern;
+
+        waiting_verifiers.clear();
+        verified_children.clear();
+
+        if (incremental_verification) {
+            auto const end_ranges = bit_parallel_alignment::alignment_end_ranges(
+                reference_subspans,
+                pattern,
+                curr_pex_node.num_errors
+            );
+
+            for (size_t i = 0; i < verifiers_of_this_node.size(); ++i) {
+                if (!end_ranges[i].has_value()) {
+                    continue;
+                }
+
+                waiting_verifiers.emplace_back(std::move(verifiers_of_this_node[i]));
+                verified_children.emplace_back(internal::verified_child {
+                    .pex_node = curr_pex_node,
+                    .end_range = bit_parallel_alignment::alignment_end_range {
+                        .min_end_position = reference_span_offsets[i] + end_ranges[i]->min_end_position,
+                        .max_end_position_minus_num_errors =
+                            reference_span_offsets[i] + end_ranges[i]->max_end_position_minus_num_errors
+                    }
+                });
+            }
+        } else {
+            auto const alignments_exist = bit_parallel_alignment::alignments_exist(
+                reference_subspans,
+                pattern,
+                curr_pex_node.num_errors
+            );
+
+            for (size_t i = 0; i < verifiers_of_this_node.size(); ++i) {
+                if (alignments_exist[i]) {
+                    waiting_verifiers.emplace_back(std::move(verifiers_of_this_node[i]));
+                    verified_children.emplace_back(std::nullopt);
+                }
+            }
+        }
+
+        curr_pex_node = pex_tree.get_parent_of_child(curr_pex_node);
+    }
+
+    for (size_t i = 0; i < waiting_verifiers.size(); ++i) {
+        // the root of the same reference region might have been verified by one of the previous anchors
+        if (waiting_verifiers[i].root_was_already_verified()) {
+            continue;
+        }
+
+        waiting_verifiers[i].verify_node_of_hierarchy(pex_tree.root(), verified_children[i]);
+    }
+}
+
+query_verifier batched_query_verifier::verifier_for(search::anchor_t const& anchor) const {
+    return query_verifier {
+        .pex_tree = pex_tree,
+        .anchor = anchor,
+        .pex_leaf_node = pex_leaf_node,
+        .query = query,
+        .orientation = orientation,
+        .reference = references.records[anchor.reference_id],
+        .kind = kind,
+        .already_verified_intervals = verified_intervals_for_all_references.at(anchor.reference_id),
+        .extra_verification_ratio = extra_verification_ratio,
+        .without_cigar = without_cigar,
+        .alignment_implementation = alignment_implementation,
+        .alignments = alignments,
+        .stats = stats,
+        .profile = profile,
+        .incremental_verification = incremental_verification
+    };
 }
 
 namespace internal {
@@ -183,6 +420,90 @@ span_config compute_reference_span_start_and_length(
     };
 }
 
+span_config narrow_reference_span_to_verified_child(
+    span_config const reference_span_config,
+    pex::pex_tree::node const& pex_node,
+    verified_child const& child
+) {
+    auto const& end_range = child.end_range;
+    size_t const extra_length = reference_span_config.applied_extra_verification_length_per_side;
+
+    // an alignment of this node that contains an alignment of the child ending at position e with s errors
+    // covers the query before the end of the child with at most pex_node.num_errors errors and the query
+    // after the end of the child with at most pex_node.num_errors - s errors
+    size_t const query_length_until_child_end = child.pex_node.query_index_to + 1 - pex_node.query_index_from;
+    size_t const query_length_after_child_end = pex_node.query_index_to - child.pex_node.query_index_to;
+
+    int64_t const start_signed = static_cast<int64_t>(end_range.min_end_position) -
+        static_cast<int64_t>(query_length_until_child_end) -
+        static_cast<int64_t>(pex_node.num_errors) -
+        static_cast<int64_t>(extra_length);
+    size_t const end = end_range.max_end_position_minus_num_errors + query_length_after_child_end +
+        pex_node.num_errors + extra_length;
+
+    size_t const narrowed_start = std::max(
+        reference_span_config.offset,
+        start_signed >= 0 ? static_cast<size_t>(start_signed) : 0
+    );
+    size_t const narrowed_end = std::min(reference_span_config.offset + reference_span_config.length, end);
+
+    return span_config {
+        .offset = narrowed_start,
+        .length = narrowed_end > narrowed_start ? narrowed_end - narrowed_start : 0,
+        .applied_extra_verification_length_per_side = extra_length
+    };
+}
+
+// The references are stored packed and the alignment kernels need the ranks of the reference span unpacked.
+// The scratch buffer is reused for every verification of the calling thread.
+static std::span<const uint8_t> unpack_reference_span(
+    input::reference_record const& reference,
+    span_config const reference_span_config,
+    std::vector<uint8_t>& scratch
+) {
+    scratch.resize(reference_span_config.length);
+    reference.rank_sequence.unpack_into(reference_span_config.offset, scratch);
+
+    return scratch;
+}
+
+std::optional<bit_parallel_alignment::alignment_end_range> compute_end_range_of_pex_node_query_in_reference_span(
+    pex::pex_tree::node const& pex_node,
+    input::reference_record const& reference,
+    span_config const reference_span_config,
+    std::span<const uint8_t> const query,
+    query_profile const* const profile,
+    statistics::search_and_alignment_statistics& stats
+) {
+    assert(!pex_node.is_root());
+
+    thread_local std::vector<uint8_t> reference_span_scratch{};
+    auto const reference_subspan = unpack_reference_span(reference, reference_span_config, reference_span_scratch);
+
+    std::optional<bit_parallel_alignment::query_pattern> computed_pattern;
+    if (profile == nullptr) {
+        computed_pattern.emplace(query.subspan(pex_node.query_index_from, pex_node.length_of_query_span()));
+    }
+
+    auto const end_range = bit_parallel_alignment::alignment_end_range_of(
+        reference_subspan,
+        profile != nullptr ? profile->pattern_of(pex_node) : *computed_pattern,
+        pex_node.num_errors
+    );
+
+    stats.add_reference_span_size_aligned_inner_node(reference_span_config.length);
+
+    if (!end_range.has_value()) {
+        return std::nullopt;
+    }
+
+    return bit_parallel_alignment::alignment_end_range {
+        .min_end_position = reference_span_config.offset + end_range->min_end_position,
+        .max_end_position_minus_num_errors =
+            reference_span_config.offset + end_range->max_end_position_minus_num_errors
+    };
+}
+
 alignment::alignment_outcome try_to_align_pex_node_query_with_reference_span(
     pex::pex_tree::node const& pex_node,
     input::reference_record const& reference,
@@ -190,6 +511,8 @@ alignment::alignment_outcome try_to_align_pex_node_query_with_reference_span(
     std::span<const uint8_t> const query,
     alignment::query_orientation const orientation,
     bool const without_cigar,
+    alignment::alignment_implementation const alignment_implementation,
+    query_profile const* const profile,
     alignment::query_alignments& alignments,
     statistics::search_and_alignment_statistics& stats
 ) {
@@ -198,10 +521,8 @@ alignment::alignment_outcome try_to_align_pex_node_query_with_reference_span(
         pex_node.length_of_query_span()
     );
 
-    auto const reference_subspan = std::span<const uint8_t>(reference.rank_sequence).subspan(
-        reference_span_config.offset,
-        reference_span_config.length
-    );
+    thread_local std::vector<uint8_t> reference_span_scratch{};
+    auto const reference_subspan = unpack_reference_span(reference, reference_span_config, reference_span_scratch);
 
     auto mode = alignment::alignment_mode::only_verify_existance;
     if (pex_node.is_root()) {
@@ -216,7 +537,10 @@ alignment::alignment_outcome try_to_align_pex_node_query_with_reference_span(
         .reference_span_offset = reference_span_config.offset,
         .num_allowed_errors = pex_node.num_errors,
         .orientation = orientation,
-        .mode = mode
+        .mode = mode,
+        .implementation = alignment_implementation,
+        .query_pattern = profile != nullptr ? &profile->pattern_of(pex_node) : nullptr,
+        .reverse_query_pattern = profile != nullptr && pex_node.is_root() ? &profile->reverse_root_pattern() : nullptr
     };
 
     auto const alignment_result = alignment::align(
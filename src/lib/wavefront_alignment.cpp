@@ -0,0 +1,340 @@
+#include <math.hpp>
+#include <multiversioning.hpp>
+#include <wavefront_alignment.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <vector>
+
+namespace wavefront_alignment {
+
+using bit_parallel_alignment::alignment_end;
+using bit_parallel_alignment::alignment_with_cigar;
+using bit_parallel_alignment::sequence_direction;
+
+namespace internal {
+
+// query positions are stored as 32 bit integers to halve the memory usage of the traceback
+static constexpr int32_t unreachable = std::numeric_limits<int32_t>::min() / 2;
+
+// the furthest reaching query positions of the diagonals [lowest_diagonal, lowest_diagonal + size) for one score
+struct wavefront {
+    int64_t lowest_diagonal;
+    std::vector<int32_t> furthest_query_positions;
+
+    int64_t highest_diagonal() const {
+        return lowest_diagonal + static_cast<int64_t>(furthest_query_positions.size()) - 1;
+    }
+
+    int32_t at(int64_t const diagonal) const {
+        if (diagonal < lowest_diagonal || diagonal > highest_diagonal()) {
+            return unreachable;
+        }
+
+        return furthest_query_positions[diagonal - lowest_diagonal];
+    }
+};
+
+// ranks outside of the rank alphabet never match, like in the bit-parallel kernel
+static bool ranks_match(uint8_t const query_rank, uint8_t const reference_rank) {
+    return query_rank == reference_rank && query_rank < bit_parallel_alignment::rank_alphabet_size;
+}
+
+// Positions are given in the direction in which the sequences are processed. Cells are (query position,
+// reference position) of the DP matrix, where the first row (query position 0) has score 0 everywhere.
+// The diagonal of a cell is its reference position minus its query position.
+template<sequence_direction direction>
+class wavefront_computation {
+public:
+    wavefront_computation(
+        std::span<const uint8_t> const reference_,
+        std::span<const uint8_t> const query_,
+        size_t const max_num_errors_,
+        bool const store_all_wavefronts_
+    ) : reference{reference_},
+        query{query_},
+        reference_length{static_cast<int64_t>(reference_.size())},
+        query_length{static_cast<int64_t>(query_.size())},
+        max_num_errors{max_num_errors_},
+        store_all_wavefronts{store_all_wavefronts_} {}
+
+    // computes the wavefronts for increasing scores until the query can be aligned completely
+    std::optional<alignment_end> compute_best_end() {
+        std::optional<wavefront> first = wavefront_of_score(0);
+        if (!first.has_value()) {
+            return std::nullopt;
+        }
+
+        std::fill(first->furthest_query_positions.begin(), first->furthest_query_positions.end(), 0);
+        wavefronts.emplace_back(std::move(*first));
+
+        for (size_t score = 0; ; ++score) {
+            extend(wavefronts.back());
+
+            auto const end = best_end_of(wavefronts.back(), score);
+            if (end.has_value() || score == max_num_errors) {
+                return end;
+            }
+
+            std::optional<wavefront> next = wavefront_of_score(score + 1);
+            if (!next.has_value()) {
+                return std::nullopt;
+            }
+
+            compute_next(wavefronts.back(), *next);
+
+            if (!store_all_wavefronts) {
+                wavefronts.clear();
+            }
+            wavefronts.emplace_back(std::move(*next));
+        }
+    }
+
+    // the operations from the end of the alignment to its beginning. Prefers diagonal steps over insertions and
+    // insertions over deletions, like the traceback of the bit-parallel kernel.
+    // The wavefronts of all scores up to the one of the end have to be stored
+    std::vector<char> traceback(alignment_end const& end, size_t& start_position) const {
+        assert(store_all_wavefronts);
+
+        std::vector<char> reverse_operations{};
+        reverse_operations.reserve(query.size() + end.num_errors);
+
+        int64_t query_position = query_length;
+        int64_t reference_position = static_cast<int64_t>(end.end_position);
+        size_t score = end.num_errors;
+
+        // a cell has a score of at most s if and only if the wavefront of s reaches it on its diagonal.
+        // Neighboring cells differ by at most one, so this also checks for a score of exactly s
+        auto const has_score_at_most = [this] (size_t const s, int64_t const query_pos, int64_t const reference_pos) {
+            return wavefronts[s].at(reference_pos - query_pos) >= query_pos;
+        };
+
+        while (query_position > 0 && reference_position > 0) {
+            if (ranks_match(query_at(query_position - 1), reference_at(reference_position - 1))) {
+                reverse_operations.push_back('=');
+                --query_position;
+                --reference_position;
+            } else if (score > 0 && has_score_at_most(score - 1, query_position - 1, reference_position - 1)) {
+                reverse_operations.push_back('X');
+                --score;
+                --query_position;
+                --reference_position;
+            } else if (score > 0 && has_score_at_most(score - 1, query_position - 1, reference_position)) {
+                reverse_operations.push_back('I');
+                --score;
+                --query_position;
+            } else {
+                assert(score > 0 && has_score_at_most(score - 1, query_position, reference_position - 1));
+                reverse_operations.push_back('D');
+                --score;
+                --reference_position;
+            }
+        }
+
+        // the remaining query characters at the very beginning of the reference are insertions
+        reverse_operations.insert(reverse_operations.end(), query_position, 'I');
+
+        start_position = static_cast<size_t>(reference_position);
+
+        return reverse_operations;
+    }
+
+private:
+    uint8_t reference_at(int64_t const position) const {
+        if constexpr (direction == sequence_direction::forward) {
+            return reference[position];
+        } else {
+            return reference[reference_length - 1 - position];
+        }
+    }
+
+    uint8_t query_at(int64_t const position) const {
+        if constexpr (direction == sequence_direction::forward) {
+            return query[position];
+        } else {
+            return query[query_length - 1 - position];
+        }
+    }
+
+    // Every diagonal below -score can only be reached with more errors. Every diagonal above
+    // (reference length - query length + max_num_errors - score) can not reach the last query row with the
+    // remaining errors, because only insertions decrease the diagonal. Returns std::nullopt if no diagonal is left
+    std::optional<wavefront> wavefront_of_score(size_t const score) const {
+        int64_t const lowest_diagonal = -static_cast<int64_t>(score);
+        int64_t const highest_diagonal = std::min(
+            reference_length,
+            reference_length - query_length + static_cast<int64_t>(max_num_errors) - static_cast<int64_t>(score)
+        );
+
+        if (highest_diagonal < lowest_diagonal) {
+            return std::nullopt;
+        }
+
+        return wavefront {
+            .lowest_diagonal = lowest_diagonal,
+            .furthest_query_positions = std::vector<int32_t>(highest_diagonal - lowest_diagonal + 1, unreachable)
+        };
+    }
+
+    void compute_next(wavefront const& previous, wavefront& next) const {
+        for (int64_t diagonal = next.lowest_diagonal; diagonal <= next.highest_diagonal(); ++diagonal) {
+            int64_t query_position = previous.at(diagonal);
+
+            int64_t const after_mismatch = previous.at(diagonal) + 1;
+            if (after_mismatch <= query_length && after_mismatch + diagonal <= reference_length) {
+                query_position = std::max(query_position, after_mismatch);
+            }
+
+            int64_t const after_insertion = previous.at(diagonal + 1) + 1;
+            if (after_insertion <= query_length) {
+                query_position = std::max(query_position, after_insertion);
+            }
+
+            int64_t const after_deletion = previous.at(diagonal - 1);
+            if (after_deletion + diagonal <= reference_length) {
+                query_position = std::max(query_position, after_deletion);
+            }
+
+            next.furthest_query_positions[diagonal - next.lowest_diagonal] = query_position < 0 ?
+                unreachable : static_cast<int32_t>(query_position);
+        }
+    }
+
+    // skips the matches along every diagonal
+    void extend(wavefront& w) const {
+        for (int64_t diagonal = w.lowest_diagonal; diagonal <= w.highest_diagonal(); ++diagonal) {
+            int32_t& furthest_query_position = w.furthest_query_positions[diagonal - w.lowest_diagonal];
+            if (furthest_query_position == unreachable) {
+                continue;
+            }
+
+            int64_t query_position = furthest_query_position;
+            int64_t reference_position = query_position + diagonal;
+
+            while (
+                query_position < query_length &&
+                reference_position < reference_length &&
+                ranks_match(query_at(query_position), reference_at(reference_position))
+            ) {
+                ++query_position;
+                ++reference_position;
+            }
+
+            furthest_query_position = static_cast<int32_t>(query_position);
+        }
+    }
+
+    // ties are broken by choosing the largest end position, like in the bit-parallel kernel
+    std::optional<alignment_end> best_end_of(wavefront const& w, size_t const score) const {
+        for (int64_t diagonal = w.highest_diagonal(); diagonal >= w.lowest_diagonal; --diagonal) {
+            if (w.at(diagonal) == query_length && query_length + diagonal > 0) {
+                return alignment_end {
+                    .num_errors = score,
+                    .end_position = static_cast<size_t>(query_length + diagonal)
+                };
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::span<const uint8_t> const reference;
+    std::span<const uint8_t> const query;
+    int64_t const reference_length;
+    int64_t const query_length;
+    size_t const max_num_errors;
+    bool const store_all_wavefronts;
+
+    // all wavefronts up to the current score, or only the current one
+    std::vector<wavefront> wavefronts{};
+};
+
+template<sequence_direction direction>
+FLOXER_MULTIVERSIONED
+static std::optional<alignment_end> best_alignment_end_in_direction(
+    std::span<const uint8_t> const reference,
+    std::span<const uint8_t> const query,
+    size_t const max_num_errors
+) {
+    wavefront_computation<direction> computation(reference, query, max_num_errors, false);
+
+    return computation.compute_best_end();
+}
+
+FLOXER_MULTIVERSIONED
+static std::optional<alignment_with_cigar> best_alignment_with_cigar_forward(
+    std::span<const uint8_t> const reference,
+    std::span<const uint8_t> const query,
+    size_t const max_num_errors
+) {
+    wavefront_computation<sequence_direction::forward> computation(reference, query, max_num_errors, true);
+
+    auto const best_end = computation.compute_best_end();
+    if (!best_end.has_value()) {
+        return std::nullopt;
+    }
+
+    size_t start_position = 0;
+    auto const reverse_operations = computation.traceback(*best_end, start_position);
+
+    return alignment_with_cigar {
+        .num_errors = best_end->num_errors,
+        .start_position = start_position,
+        .cigar = bit_parallel_alignment::internal::run_length_encode(reverse_operations)
+    };
+}
+
+} // namespace internal
+
+std::optional<alignment_end> best_alignment_end(
+    std::span<const uint8_t> const reference,
+    std::span<const uint8_t> const query,
+    size_t const max_num_errors,
+    sequence_direction const direction
+) {
+    assert(max_num_errors < query.size());
+
+    if (direction == sequence_direction::forward) {
+        return internal::best_alignment_end_in_direction<sequence_direction::forward>(
+            reference, query, max_num_errors
+        );
+    } else {
+        return internal::best_alignment_end_in_direction<sequence_direction::reverse>(
+            reference, query, max_num_errors
+        );
+    }
+}
+
+std::optional<alignment_with_cigar> best_alignment_with_cigar(
+    std::span<const uint8_t> const reference,
+    std::span<const uint8_t> const query,
+    size_t const max_num_errors
+) {
+    assert(max_num_errors < query.size());
+
+    return internal::best_alignment_with_cigar_forward(reference, query, max_num_errors);
+}
+
+size_t max_num_errors_cheaper_than_bit_parallel(
+    size_t const reference_length,
+    size_t const query_length,
+    size_t const max_num_errors
+) {
+    size_t const reference_surplus = reference_length >= query_length ? reference_length - query_length : 0;
+
+    // the bit-parallel kernel advances every block of the band once per reference column
+    size_t const num_band_blocks = std::min(
+        math::ceil_div(query_length, bit_parallel_alignment::word_size),
+        math::ceil_div(reference_surplus + 2 * max_num_errors, bit_parallel_alignment::word_size) + 1
+    );
+    size_t const bit_parallel_work = reference_length * num_band_blocks;
+
+    // the wavefronts advance every diagonal once per score. They are only computed up to half of the work of the
+    // kernel, such that a failed attempt (followed by the kernel) costs at most 50% extra
+    size_t const num_diagonals = reference_surplus + max_num_errors + 1;
+
+    return std::min(max_num_errors, bit_parallel_work / num_diagonals / 2);
+}
+
+} // namespace wavefront_alignment
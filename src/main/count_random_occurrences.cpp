@@ -4,6 +4,7 @@
 
 #include <random>
 #include <span>
+#include <variant>
 #include <vector>
 
 #include <fmindex-collection/search/SearchNg21.h>
@@ -89,7 +90,7 @@ int main(int argc, char** argv)  {
     auto index = input::load_index(index_path);
 
     std::mt19937 random_generator(837103474);
-    search::internal::search_scheme_cache scheme_cache;
+    search::search_scheme_cache scheme_cache;
 
     fmt::print("runs = [\n");
 
@@ -109,18 +110,20 @@ int main(int argc, char** argv)  {
 
                 size_t count = 0;
 
-                fmindex_collection::search_ng21::search(
-                    index,
-                    std::span(seq),
-                    search_scheme,
-                    [&count] (
-                        [[maybe_unused]] size_t const _seed_index_in_wrapper_range,
-                        auto cursor,
-                        [[maybe_unused]] size_t const _errors
-                    ) {
-                        count += cursor.count();
-                    }
-                );
+                std::visit([&] (auto const& typed_index) {
+                    fmindex_collection::search_ng21::search(
+                        typed_index,
+                        std::span(seq),
+                        search_scheme,
+                        [&count] (
+                            [[maybe_unused]] size_t const _seed_index_in_wrapper_range,
+                            auto cursor,
+                            [[maybe_unused]] size_t const _errors
+                        ) {
+                            count += cursor.count();
+                        }
+                    );
+                }, index);
 
                 average_count += count / static_cast<double>(num_searches_per_length);
             }
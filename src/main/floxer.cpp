@@ -1,8 +1,10 @@
 #include <alignment.hpp>
 #include <floxer_cli.hpp>
 #include <fmindex.hpp>
+#include <index_construction.hpp>
 #include <input.hpp>
 #include <intervals.hpp>
+#include <kmer_cursor_table.hpp>
 #include <mutex_wrapper.hpp>
 #include <output.hpp>
 #include <parallelization.hpp>
@@ -22,12 +24,14 @@
 #include <ranges>
 #include <span>
 #include <thread>
+#include <variant>
 #include <vector>
 
 #define BS_THREAD_POOL_ENABLE_PRIORITY
 #include <BS_thread_pool.hpp>
 
 #include <spdlog/fmt/fmt.h>
+#include <spdlog/fmt/ranges.h>
 #include <spdlog/fmt/std.h>
 #include <spdlog/spdlog.h>
 #include <spdlog/stopwatch.h>
@@ -46,29 +50,122 @@ int main(int argc, char** argv) {
     spdlog::info("successfully parsed CLI input ... starting");
     spdlog::debug("command line call: {}", cli_input.command_line_call());
 
+    bool const index_file_exists = cli_input.index_path().has_value() &&
+        std::filesystem::exists(cli_input.index_path().value());
+
+    // with an existing index, the references are read from the file next to it if possible
     input::references references;
+    bool references_were_loaded_with_index = false;
+    std::filesystem::path references_source_path = cli_input.reference_path();
+    if (index_file_exists) {
+        references_source_path = input::references_path_of_index(cli_input.index_path().value());
+
+        try {
+            auto loaded_references = input::load_references(references_source_path);
+
+            if (loaded_references.has_value()) {
+                references = std::move(loaded_references.value());
+                references_were_loaded_with_index = true;
+            }
+        } catch (std::exception const& e) {
+            spdlog::warn(
+                "An error occured while trying to read the references from "
+                "the file {}.\nContinuing with the reference file instead.\n{}\n",
+                references_source_path,
+                e.what()
+            );
+        }
+    }
+
     try {
-        references = input::read_references(cli_input.reference_path());
+        if (!references_were_loaded_with_index) {
+            references_source_path = cli_input.reference_path();
+            references = input::read_references(references_source_path);
+        }
     } catch (std::exception const& e) {
         spdlog::error(
             "An error occured while trying to read the reference from "
             "the file {}.\n{}",
-            cli_input.reference_path(),
+            references_source_path,
             e.what()
         );
         return -1;
     }
 
-    fmindex index;
-    if (
-        cli_input.index_path().has_value() &&
-        std::filesystem::exists(cli_input.index_path().value())
-    ) {
+    auto const index_config = index_construction::index_config {
+        .occurrence_table = occurrence_table_variant_from_string(cli_input.occurrence_table()),
+        .suffix_array_sampling_rate = cli_input.suffix_array_sampling_rate(),
+        .min_stripped_n_run_length = cli_input.min_stripped_n_run_length(),
+        .num_threads = cli_input.num_threads()
+    };
+
+    // an index file either contains the index of all references or the ranges of the shards of a sharded index
+    std::optional<std::vector<index_shard_range>> shard_ranges = std::nullopt;
+    if (index_file_exists) {
+        auto const ignored_options = cli_input.changed_options_of_new_indices();
+        if (!ignored_options.empty()) {
+            spdlog::warn(
+                "The index file {} already exists and is loaded as it was built. "
+                "The options --{} only apply to newly built indices and are ignored.",
+                cli_input.index_path().value(),
+                fmt::join(ignored_options, ", --")
+            );
+        }
+
+        try {
+            shard_ranges = input::load_index_shard_ranges(cli_input.index_path().value());
+        } catch (std::exception const& e) {
+            spdlog::error(
+                "An error occured while trying to load the index from "
+                "the file {}.\n{}\n",
+                cli_input.index_path().value(),
+                e.what()
+            );
+            return -1;
+        }
+
+        // index files of older versions have no references file yet
+        if (!references_were_loaded_with_index) {
+            output::save_references(references, input::references_path_of_index(cli_input.index_path().value()));
+        }
+    } else if (cli_input.index_shard_size() > 0) {
         auto const index_path = cli_input.index_path().value();
+        shard_ranges = index_construction::partition_references_into_shards(references, cli_input.index_shard_size());
+        index_construction::build_and_save_index_shards(
+            references,
+            *shard_ranges,
+            index_config,
+            cli_input.kmer_table_length(),
+            index_path
+        );
+        output::save_references(references, input::references_path_of_index(index_path));
+    }
+
+    // the k-mer table that was loaded with the index is only used if it has the k given by the user
+    auto const use_kmer_table_of_cli_input = [&cli_input] (fmindex_variant const& index, kmer_cursor_table& kmer_table) {
+        if (kmer_table.kmer_length() != cli_input.kmer_table_length()) {
+            if (cli_input.kmer_table_length() > 0) {
+                spdlog::info("the index file contains no k-mer table for k = {}", cli_input.kmer_table_length());
+                kmer_table = index_construction::build_kmer_table(index, cli_input.kmer_table_length());
+            } else {
+                kmer_table = kmer_cursor_table{};
+            }
+        }
+    };
+
+    auto const load_index_from = [&use_kmer_table_of_cli_input] (
+        std::filesystem::path const& index_path,
+        fmindex_variant& index,
+        kmer_cursor_table& kmer_table
+    ) {
         spdlog::info("loading index from {}", index_path);
 
         try {
-            index = input::load_index(index_path);
+            index = input::load_index(index_path, kmer_table);
+            spdlog::info(
+                "loaded index with the occurrence table {}",
+                to_string(occurrence_table_variant_of(index))
+            );
         } catch (std::exception const& e) {
             spdlog::error(
                 "An error occured while trying to load the index from "
@@ -76,51 +173,93 @@ int main(int argc, char** argv) {
                 index_path,
                 e.what()
             );
-            return -1;
+            return false;
         }
-    } else {
-        spdlog::info(
-            "building index with {} thread{}",
-            cli_input.num_threads(),
-            cli_input.num_threads() == 1 ? "" : "s"
-        );
 
-        spdlog::stopwatch const build_index_stopwatch;
+        use_kmer_table_of_cli_input(index, kmer_table);
 
-        // This sampling rate is a trade-off for high speed. It leads to and index size of 11G
-        // for the human genome, which should be tolerable in most applications
-        size_t constexpr suffix_array_sampling_rate = 4;
-        index = fmindex(
-            references.records | std::views::transform(&input::reference_record::rank_sequence),
-            suffix_array_sampling_rate,
-            cli_input.num_threads()
-        );
+        return true;
+    };
 
-        spdlog::info(
-            "building index took {}",
-            output::format_elapsed_time(build_index_stopwatch.elapsed())
-        );
+    // the schemes of longer seeds are created on demand
+    size_t constexpr max_prewarmed_seed_length = 512;
+    search::search_scheme_cache scheme_cache;
+    scheme_cache.prewarm(pex::predicted_search_scheme_keys(cli_input, max_prewarmed_seed_length));
+    spdlog::debug("prewarmed {} search schemes", scheme_cache.num_prewarmed_schemes());
+
+    auto const searcher_of = [&] (
+        fmindex_variant const& index,
+        kmer_cursor_table const& kmer_table,
+        size_t const first_reference_id
+    ) {
+        return search::searcher {
+            .index = index,
+            .scheme_cache = scheme_cache,
+            .kmer_table = kmer_table,
+            .num_reference_sequences = references.records.size(),
+            .config = search::search_config{
+                .max_num_anchors_hard = cli_input.max_num_anchors_hard(),
+                .max_num_anchors_soft = cli_input.max_num_anchors_soft(),
+                .anchor_group_order = search::anchor_group_order_from_string(cli_input.anchor_group_order()),
+                .anchor_choice_strategy = search::anchor_choice_strategy_from_string(
+                    cli_input.anchor_choice_strategy()
+                ),
+                .erase_useless_anchors = !cli_input.dont_erase_useless_anchors(),
+                .interleaved_seed_search = cli_input.interleaved_seed_search()
+            },
+            .first_reference_id = first_reference_id
+        };
+    };
+
+    bool const search_shards_one_at_a_time = shard_ranges.has_value() && cli_input.shard_search() == "one_at_a_time";
+
+    // the index of all references or of all shards, unless only one shard at a time is in memory
+    std::vector<fmindex_variant> indices{};
+    std::vector<kmer_cursor_table> kmer_tables{};
+    std::vector<search::searcher> searchers{};
+
+    if (!shard_ranges.has_value()) {
+        indices.resize(1);
+        kmer_tables.resize(1);
 
-        if (cli_input.index_path().has_value()) {
-            output::save_index(index, cli_input.index_path().value());
+        if (index_file_exists) {
+            if (!load_index_from(cli_input.index_path().value(), indices.front(), kmer_tables.front())) {
+                return -1;
+            }
+        } else {
+            indices.front() = index_construction::build_index(references, index_config);
+
+            if (cli_input.kmer_table_length() > 0) {
+                kmer_tables.front() = index_construction::build_kmer_table(
+                    indices.front(),
+                    cli_input.kmer_table_length()
+                );
+            }
+
+            if (cli_input.index_path().has_value()) {
+                output::save_index(indices.front(), kmer_tables.front(), cli_input.index_path().value());
+                output::save_references(references, input::references_path_of_index(cli_input.index_path().value()));
+            }
         }
-    }
 
-    mutex_guarded<input::queries> queries(cli_input);
-
-    auto const searcher = search::searcher {
-        .index = index,
-        .num_reference_sequences = references.records.size(),
-        .config = search::search_config{
-            .max_num_anchors_hard = cli_input.max_num_anchors_hard(),
-            .max_num_anchors_soft = cli_input.max_num_anchors_soft(),
-            .anchor_group_order = search::anchor_group_order_from_string(cli_input.anchor_group_order()),
-            .anchor_choice_strategy = search::anchor_choice_strategy_from_string(
-                cli_input.anchor_choice_strategy()
-            ),
-            .erase_useless_anchors = !cli_input.dont_erase_useless_anchors()
+        searchers.emplace_back(searcher_of(indices.front(), kmer_tables.front(), 0));
+    } else if (!search_shards_one_at_a_time) {
+        indices.resize(shard_ranges->size());
+        kmer_tables.resize(shard_ranges->size());
+
+        for (size_t shard_id = 0; shard_id < shard_ranges->size(); ++shard_id) {
+            auto const shard_path = input::shard_path_of_index(cli_input.index_path().value(), shard_id);
+            if (!load_index_from(shard_path, indices[shard_id], kmer_tables[shard_id])) {
+                return -1;
+            }
+
+            searchers.emplace_back(searcher_of(
+                indices[shard_id],
+                kmer_tables[shard_id],
+                (*shard_ranges)[shard_id].first_reference_id
+            ));
         }
-    };
+    }
 
     mutex_guarded<output::alignment_output> alignment_output(
         cli_input.output_path(),
@@ -140,6 +279,32 @@ int main(int argc, char** argv) {
 
     BS::thread_pool thread_pool(cli_input.num_threads());
 
+    // every pass reads all queries from the beginning
+    auto const align_all_queries = [&] (
+        std::vector<search::searcher> const& searchers,
+        parallelization::alignment_pass const pass
+    ) {
+        mutex_guarded<input::queries> queries(cli_input);
+
+        // initialize thread pool task queue with a search task for every thread
+        for (size_t t = 0; t < cli_input.num_threads(); ++t) {
+            parallelization::spawn_search_task(
+                queries,
+                references,
+                cli_input,
+                searchers,
+                pass,
+                alignment_output,
+                global_stats,
+                thread_pool,
+                threads_should_stop
+            );
+        }
+
+        // wait for all tasks to complete
+        thread_pool.wait();
+    };
+
     auto const query_file_size_bytes = std::filesystem::file_size(cli_input.queries_path());
     spdlog::info(
         "aligning queries from a {} bytes large file against {} references with {} thread{} "
@@ -153,22 +318,35 @@ int main(int argc, char** argv) {
 
     spdlog::stopwatch const aligning_stopwatch;
 
-    // initialize thread pool task queue with a search task for every thread
-    for (size_t t = 0; t < cli_input.num_threads(); ++t) {
-        parallelization::spawn_search_task(
-            queries,
-            references,
-            cli_input,
-            searcher,
-            alignment_output,
-            global_stats,
-            thread_pool,
-            threads_should_stop
-        );
-    }
+    if (!search_shards_one_at_a_time) {
+        if (shard_ranges.has_value()) {
+            spdlog::info("searching every query in all {} index shards", shard_ranges->size());
+        }
+
+        align_all_queries(searchers, parallelization::single_pass);
+    } else {
+        spdlog::info("searching the {} index shards one after another", shard_ranges->size());
+
+        mutex_guarded<alignment::collected_query_alignments> collected_alignments;
 
-    // wait for all tasks to complete
-    thread_pool.wait();
+        for (size_t shard_id = 0; shard_id < shard_ranges->size() && !threads_should_stop; ++shard_id) {
+            fmindex_variant index;
+            kmer_cursor_table kmer_table;
+
+            auto const shard_path = input::shard_path_of_index(cli_input.index_path().value(), shard_id);
+            if (!load_index_from(shard_path, index, kmer_table)) {
+                return -1;
+            }
+
+            std::vector<search::searcher> const searchers_of_shard{
+                searcher_of(index, kmer_table, (*shard_ranges)[shard_id].first_reference_id)
+            };
+            align_all_queries(searchers_of_shard, parallelization::alignment_pass {
+                .collected_alignments = &collected_alignments,
+                .is_last_pass = shard_id + 1 == shard_ranges->size()
+            });
+        }
+    }
 
     if (threads_should_stop) {
         return -1;
@@ -0,0 +1,154 @@
+#include <about_floxer.hpp>
+#include <floxer_cli.hpp>
+#include <fmindex.hpp>
+#include <index_construction.hpp>
+#include <input.hpp>
+#include <kmer_cursor_table.hpp>
+#include <output.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sharg/all.hpp>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/fmt/std.h>
+#include <spdlog/spdlog.h>
+
+// Builds the index file (and the references file next to it) that floxer reads with --index, without
+// reading any queries. It uses the same index construction as floxer and therefore needs about as much memory.
+// The only difference is that the packed references are released before the construction of a single index.
+int main(int argc, char** argv) {
+    sharg::parser parser{ "floxer_index", argc, argv, sharg::update_notifications::off };
+
+    parser.info.author = about_floxer::author;
+    parser.info.description = {
+        "Build the FM-index of the references for floxer and store it in a file that can be given to floxer "
+        "with --index."
+    };
+    parser.info.email = about_floxer::email;
+    parser.info.url = about_floxer::url;
+    parser.info.short_description = "Build the FM-index for floxer";
+    parser.info.synopsis = {
+        "./floxer_index --reference hg38.fasta --index hg38.flxi",
+    };
+    parser.info.version = "1.0.0";
+
+    std::filesystem::path reference_path{};
+    std::filesystem::path index_path{};
+    std::filesystem::path logfile_path{};
+    cli::index_construction_options index_options{};
+    size_t num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    parser.add_option(reference_path, sharg::config{
+        .short_id = 'r',
+        .long_id = "reference",
+        .description = "The reference sequences in FASTA format.",
+        .required = true,
+        .validator = sharg::input_file_validator{
+            {
+                "fa", "fasta", "fna", "ffn", "fas", "faa", "mpfa", "frn",
+                "fa.gz", "fasta.gz", "fna.gz", "ffn.gz", "fas.gz", "faa.gz", "mpfa.gz", "frn.gz"
+            }
+        }
+    });
+
+    parser.add_option(index_path, sharg::config{
+        .short_id = 'i',
+        .long_id = "index",
+        .description = "The file where the index is stored. The references are stored next to it "
+            "(with the additional extension .references).",
+        .required = true
+    });
+
+    parser.add_option(logfile_path, sharg::config{
+        .short_id = 'l',
+        .long_id = "logfile",
+        .description = "A file where the log is written to, in addition to the console.",
+        .default_message = "no logfile"
+    });
+
+    index_options.add_to(parser, false);
+
+    parser.add_option(num_threads, sharg::config{
+        .short_id = 't',
+        .long_id = "threads",
+        .description = "The number of threads to use for the construction of the index.",
+        .default_message = "all cores",
+        .validator = sharg::arithmetic_range_validator{1ul, 1024ul}
+    });
+
+    try {
+        parser.parse();
+    } catch (std::exception const& e) {
+        fmt::print(stderr, "[CLI PARSER ERROR]\n{}\n", e.what());
+        return -1;
+    }
+
+    output::initialize_logger(
+        logfile_path.empty() ? std::nullopt : std::make_optional(logfile_path),
+        false
+    );
+
+    input::references references;
+    try {
+        references = input::read_references(reference_path);
+    } catch (std::exception const& e) {
+        spdlog::error(
+            "An error occured while trying to read the reference from "
+            "the file {}.\n{}",
+            reference_path,
+            e.what()
+        );
+        return -1;
+    }
+
+    output::save_references(references, input::references_path_of_index(index_path));
+
+    auto const config = index_construction::index_config {
+        .occurrence_table = occurrence_table_variant_from_string(index_options.occurrence_table.value),
+        .suffix_array_sampling_rate = index_options.suffix_array_sampling_rate.value,
+        .min_stripped_n_run_length = index_options.min_stripped_n_run_length.value,
+        .num_threads = num_threads
+    };
+
+    size_t const kmer_table_length = index_options.kmer_table_length.value;
+
+    if (index_options.index_shard_size.value > 0) {
+        // the packed references are needed to unpack the references of one shard at a time
+        auto const shard_ranges = index_construction::partition_references_into_shards(
+            references,
+            index_options.index_shard_size.value
+        );
+        index_construction::build_and_save_index_shards(
+            references,
+            shard_ranges,
+            config,
+            kmer_table_length,
+            index_path
+        );
+
+        return 0;
+    }
+
+    auto const index = [&] () {
+        // only the unpacked references are needed for the construction
+        auto const unpacked_references = index_construction::unpack_references(references);
+        references = input::references{};
+
+        return index_construction::build_index(unpacked_references, config);
+    }();
+
+    kmer_cursor_table kmer_table{};
+    if (kmer_table_length > 0) {
+        kmer_table = index_construction::build_kmer_table(index, kmer_table_length);
+    }
+
+    output::save_index(index, kmer_table, index_path);
+
+    return 0;
+}
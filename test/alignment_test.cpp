@@ -1,5 +1,11 @@
 #include <alignment.hpp>
 
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <span>
+#include <vector>
+
 #include <seqan3/io/sam_file/detail/cigar.hpp>
 
 #include <gtest/gtest.h>
@@ -28,3 +34,299 @@ TEST(alignment, small_wrapped_seqan3) {
     EXPECT_EQ(result.alignment.value().start_in_reference, 2);
     EXPECT_EQ(result.alignment.value().cigar, seqan3::detail::parse_cigar("4=1X2="));
 }
+
+TEST(alignment, bit_parallel_existence_matches_seqan3) {
+    using namespace alignment;
+
+    std::mt19937 random_engine(42);
+    std::uniform_int_distribution<int> rank_distribution(1, 4);
+
+    for (size_t query_length : { 10ul, 63ul, 64ul, 65ul, 130ul, 300ul }) {
+        std::vector<uint8_t> query(query_length);
+        std::ranges::generate(query, [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); });
+
+        // the reference contains a mutated copy of the query
+        std::vector<uint8_t> reference(query_length + 50);
+        std::ranges::generate(reference, [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); });
+        for (size_t i = 0; i < query_length; i += 7) {
+            reference[25 + i] = query[i];
+        }
+
+        for (size_t num_allowed_errors = 0; num_allowed_errors <= query_length; num_allowed_errors += 3) {
+            auto const config_for = [num_allowed_errors] (alignment_implementation const implementation) {
+                return alignment_config {
+                    .reference_span_offset = 0,
+                    .num_allowed_errors = num_allowed_errors,
+                    .orientation = query_orientation::forward,
+                    .mode = alignment_mode::only_verify_existance,
+                    .implementation = implementation
+                };
+            };
+
+            EXPECT_EQ(
+                align(reference, query, config_for(alignment_implementation::bit_parallel)).outcome,
+                align(reference, query, config_for(alignment_implementation::seqan3)).outcome
+            );
+        }
+    }
+}
+
+TEST(alignment, bit_parallel_without_cigar) {
+    using namespace alignment;
+
+    std::vector<uint8_t> reference{ 0, 0, 1, 2, 1, 3, 0, 2, 2, 3, 0, 1 };
+    std::vector<uint8_t> query{ 1, 2, 1, 3, 1, 2, 2 };
+
+    alignment_config const config{
+        .reference_span_offset = 100,
+        .num_allowed_errors = 2,
+        .orientation = query_orientation::reverse_complement,
+        .mode = alignment_mode::verify_and_return_alignment_without_cigar,
+        .implementation = alignment_implementation::bit_parallel
+    };
+
+    auto const result = align(reference, query, config);
+
+    EXPECT_EQ(result.outcome, alignment_outcome::alignment_exists);
+    EXPECT_TRUE(result.alignment.has_value());
+
+    EXPECT_EQ(result.alignment.value().num_errors, 1);
+    EXPECT_EQ(result.alignment.value().orientation, query_orientation::reverse_complement);
+    EXPECT_EQ(result.alignment.value().start_in_reference, 102);
+    EXPECT_TRUE(result.alignment.value().cigar.empty());
+
+    alignment_config const too_few_errors_config{
+        .reference_span_offset = 100,
+        .num_allowed_errors = 0,
+        .orientation = query_orientation::reverse_complement,
+        .mode = alignment_mode::verify_and_return_alignment_without_cigar,
+        .implementation = alignment_implementation::bit_parallel
+    };
+
+    EXPECT_EQ(align(reference, query, too_few_errors_config).outcome, alignment_outcome::no_adequate_alignment_exists);
+}
+
+// the number of edits of the alignment that starts at start_position in the reference and is described by the CIGAR,
+// or std::nullopt if the CIGAR doesn't fit the sequences
+static std::optional<size_t> num_edits_of_cigar(
+    std::span<const uint8_t> const reference,
+    std::span<const uint8_t> const query,
+    size_t const start_position,
+    std::vector<seqan3::cigar> const& cigar
+) {
+    size_t reference_position = start_position;
+    size_t query_position = 0;
+    size_t num_edits = 0;
+
+    for (auto const& cigar_element : cigar) {
+        size_t const count = get<0>(cigar_element);
+        char const operation = get<1>(cigar_element).to_char();
+
+        for (size_t i = 0; i < count; ++i) {
+            if (operation == 'I') {
+                ++query_position;
+                ++num_edits;
+                continue;
+            }
+
+            if (reference_position >= reference.size()) {
+                return std::nullopt;
+            }
+
+            if (operation == 'D') {
+                ++reference_position;
+                ++num_edits;
+                continue;
+            }
+
+            if (query_position >= query.size()) {
+                return std::nullopt;
+            }
+
+            bool const is_match = reference[reference_position] == query[query_position];
+            if ((operation == '=' && !is_match) || (operation == 'X' && is_match)) {
+                return std::nullopt;
+            }
+            if (operation != '=' && operation != 'X' && operation != 'M') {
+                return std::nullopt;
+            }
+
+            num_edits += is_match ? 0 : 1;
+            ++reference_position;
+            ++query_position;
+        }
+    }
+
+    if (query_position != query.size()) {
+        return std::nullopt;
+    }
+
+    return num_edits;
+}
+
+TEST(alignment, bit_parallel_with_cigar_matches_seqan3) {
+    using namespace alignment;
+
+    std::mt19937 random_engine(2);
+    std::uniform_int_distribution<int> rank_distribution(1, 4);
+
+    for (size_t query_length : { 10ul, 63ul, 64ul, 65ul, 130ul, 300ul }) {
+        std::vector<uint8_t> query(query_length);
+        std::ranges::generate(query, [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); });
+
+        // the reference contains a mutated copy of the query
+        std::vector<uint8_t> reference(query_length + 50);
+        std::ranges::generate(reference, [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); });
+        for (size_t i = 0; i < query_length; ++i) {
+            reference[25 + i] = query[i];
+        }
+        reference[25 + query_length / 3] = 5;
+        reference.erase(reference.begin() + 25 + query_length / 2);
+
+        for (size_t num_allowed_errors : { 0ul, 2ul, query_length / 10 + 2 }) {
+            auto const config_for = [num_allowed_errors] (alignment_implementation const implementation) {
+                return alignment_config {
+                    .reference_span_offset = 7,
+                    .num_allowed_errors = num_allowed_errors,
+                    .orientation = query_orientation::forward,
+                    .mode = alignment_mode::verify_and_return_alignment_with_cigar,
+                    .implementation = implementation
+                };
+            };
+
+            auto const bit_parallel_result = align(
+                reference, query, config_for(alignment_implementation::bit_parallel)
+            );
+            auto const seqan3_result = align(reference, query, config_for(alignment_implementation::seqan3));
+
+            ASSERT_EQ(bit_parallel_result.outcome, seqan3_result.outcome);
+            ASSERT_EQ(bit_parallel_result.alignment.has_value(), seqan3_result.alignment.has_value());
+            if (!bit_parallel_result.alignment.has_value()) {
+                continue;
+            }
+
+            EXPECT_EQ(bit_parallel_result.alignment->num_errors, seqan3_result.alignment->num_errors);
+
+            // the tie breaking between equally good alignments may differ, but both alignments must be valid
+            for (auto const& alignment : { *bit_parallel_result.alignment, *seqan3_result.alignment }) {
+                ASSERT_GE(alignment.start_in_reference, 7);
+                EXPECT_EQ(
+                    num_edits_of_cigar(reference, query, alignment.start_in_reference - 7, alignment.cigar),
+                    std::make_optional(alignment.num_errors)
+                );
+            }
+        }
+    }
+}
+
+TEST(alignment, wavefront_and_automatic_match_bit_parallel) {
+    using namespace alignment;
+
+    std::mt19937 random_engine(3);
+    std::uniform_int_distribution<int> rank_distribution(1, 4);
+
+    for (size_t query_length : { 10ul, 64ul, 130ul, 1000ul }) {
+        std::vector<uint8_t> query(query_length);
+        std::ranges::generate(query, [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); });
+
+        // the reference contains a copy of the query with few (high identity) or many errors
+        for (size_t const error_distance : { 100ul, 6ul }) {
+            std::vector<uint8_t> reference(query_length + 50);
+            std::ranges::generate(reference, [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); });
+            for (size_t i = 0; i < query_length; ++i) {
+                reference[25 + i] = i % error_distance == 3 ? 5 : query[i];
+            }
+            reference.erase(reference.begin() + 25 + query_length / 2);
+
+            for (size_t num_allowed_errors : { 0ul, 2ul, query_length / 10 + 2, query_length / 4 }) {
+                for (auto const mode : {
+                    alignment_mode::only_verify_existance,
+                    alignment_mode::verify_and_return_alignment_without_cigar,
+                    alignment_mode::verify_and_return_alignment_with_cigar
+                }) {
+                    auto const config_for = [num_allowed_errors, mode] (alignment_implementation const implementation) {
+                        return alignment_config {
+                            .reference_span_offset = 7,
+                            .num_allowed_errors = num_allowed_errors,
+                            .orientation = query_orientation::forward,
+                            .mode = mode,
+                            .implementation = implementation
+                        };
+                    };
+
+                    auto const bit_parallel_result = align(
+                        reference, query, config_for(alignment_implementation::bit_parallel)
+                    );
+
+                    for (auto const implementation : {
+                        alignment_implementation::wavefront, alignment_implementation::automatic
+                    }) {
+                        auto const result = align(reference, query, config_for(implementation));
+
+                        EXPECT_EQ(result.outcome, bit_parallel_result.outcome);
+                        EXPECT_EQ(result.alignment.has_value(), bit_parallel_result.alignment.has_value());
+                        if (result.alignment.has_value() && bit_parallel_result.alignment.has_value()) {
+                            EXPECT_EQ(*result.alignment, *bit_parallel_result.alignment);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(alignment, collected_query_alignments) {
+    using namespace alignment;
+
+    size_t const num_references = 3;
+    auto const alignment_with = [] (size_t const start_in_reference, size_t const num_errors) {
+        return query_alignment {
+            .start_in_reference = start_in_reference,
+            .num_errors = num_errors,
+            .orientation = query_orientation::forward,
+            .cigar{}
+        };
+    };
+
+    collected_query_alignments collected{};
+
+    query_alignments first_pass_alignments(num_references);
+    first_pass_alignments.insert(alignment_with(10, 2), 0);
+    first_pass_alignments.insert(alignment_with(20, 3), 0);
+    collected.add(7, std::move(first_pass_alignments));
+
+    // queries without alignments are not stored
+    collected.add(8, query_alignments(num_references));
+    EXPECT_EQ(collected.num_queries(), 1);
+
+    query_alignments second_pass_alignments(num_references);
+    second_pass_alignments.insert(alignment_with(5, 1), 2);
+    collected.add(7, std::move(second_pass_alignments));
+
+    query_alignments last_pass_alignments(num_references);
+    last_pass_alignments.insert(alignment_with(30, 4), 1);
+    collected.move_into(7, last_pass_alignments);
+
+    EXPECT_EQ(collected.num_queries(), 0);
+    EXPECT_EQ(last_pass_alignments.size(), 4);
+    EXPECT_EQ(last_pass_alignments.best_num_errors(), 1);
+    EXPECT_EQ(last_pass_alignments.to_reference(0), (std::vector{ alignment_with(10, 2), alignment_with(20, 3) }));
+    EXPECT_EQ(last_pass_alignments.to_reference(1), std::vector{ alignment_with(30, 4) });
+    EXPECT_EQ(last_pass_alignments.to_reference(2), std::vector{ alignment_with(5, 1) });
+
+    query_alignments other_query_alignments(num_references);
+    collected.move_into(8, other_query_alignments);
+    EXPECT_EQ(other_query_alignments.size(), 0);
+
+    // the times of the passes are summed up per query
+    collected.add_milliseconds_spent_in_search(7, 10);
+    collected.add_milliseconds_spent_in_search(7, 5);
+    collected.add_milliseconds_spent_in_verification(7, 3);
+    collected.add_milliseconds_spent_in_search(8, 1);
+    EXPECT_EQ(collected.num_queries(), 0);
+    EXPECT_EQ(collected.take_milliseconds_spent_in_search(7), 15);
+    EXPECT_EQ(collected.take_milliseconds_spent_in_search(7), 0);
+    EXPECT_EQ(collected.take_milliseconds_spent_in_verification(7), 3);
+    EXPECT_EQ(collected.take_milliseconds_spent_in_verification(8), 0);
+    EXPECT_EQ(collected.take_milliseconds_spent_in_search(8), 1);
+}
@@ -0,0 +1,213 @@
+#include <bit_parallel_alignment.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(bit_parallel_alignment, alignments_exist_matches_single_reference_kernel) {
+    using namespace bit_parallel_alignment;
+
+    std::mt19937 random_engine(7);
+    std::uniform_int_distribution<int> rank_distribution(1, 4);
+
+    for (size_t query_length : { 10ul, 63ul, 64ul, 65ul, 130ul, 300ul }) {
+        std::vector<uint8_t> query(query_length);
+        std::ranges::generate(query, [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); });
+
+        // some of the references contain a mutated copy of the query, the last one is shorter than the others
+        std::vector<std::vector<uint8_t>> references(2 * num_lanes + 1);
+        for (size_t i = 0; i < references.size(); ++i) {
+            auto& reference = references[i];
+            reference.resize(i + 1 == references.size() ? query_length / 2 : query_length + 30);
+            std::ranges::generate(reference, [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); });
+
+            if (i % 2 == 0 && reference.size() >= query_length + 15) {
+                for (size_t j = 0; j < query_length; j += 1 + i % 5) {
+                    reference[15 + j] = query[j];
+                }
+            }
+        }
+
+        std::vector<std::span<const uint8_t>> const reference_spans(references.begin(), references.end());
+        query_pattern const pattern(query);
+
+        for (size_t num_allowed_errors = 0; num_allowed_errors <= query_length; num_allowed_errors += 3) {
+            auto const exists = alignments_exist(reference_spans, pattern, num_allowed_errors);
+
+            ASSERT_EQ(exists.size(), references.size());
+            for (size_t i = 0; i < references.size(); ++i) {
+                EXPECT_EQ(exists[i], alignment_exists(reference_spans[i], pattern, num_allowed_errors));
+            }
+        }
+    }
+}
+
+TEST(bit_parallel_alignment, alignment_end_ranges_match_full_dp) {
+    using namespace bit_parallel_alignment;
+
+    std::mt19937 random_engine(11);
+    std::uniform_int_distribution<int> rank_distribution(1, 4);
+
+    for (size_t query_length : { 10ul, 64ul, 65ul, 130ul, 200ul, 300ul }) {
+        std::vector<uint8_t> query(query_length);
+        std::ranges::generate(query, [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); });
+
+        std::vector<std::vector<uint8_t>> references(num_lanes + 1);
+        for (size_t i = 0; i < references.size(); ++i) {
+            auto& reference = references[i];
+            reference.resize(query_length + 20 + 3 * i);
+            std::ranges::generate(reference, [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); });
+
+            for (size_t j = 0; j < query_length; j += 1 + i % 3) {
+                reference[10 + j] = query[j];
+            }
+        }
+
+        std::vector<std::span<const uint8_t>> const reference_spans(references.begin(), references.end());
+        query_pattern const pattern(query);
+
+        for (size_t num_allowed_errors = 0; num_allowed_errors < query_length; num_allowed_errors += 4) {
+            auto const end_ranges = alignment_end_ranges(reference_spans, pattern, num_allowed_errors);
+
+            ASSERT_EQ(end_ranges.size(), references.size());
+            for (size_t i = 0; i < references.size(); ++i) {
+                auto const& reference = references[i];
+
+                // semi-global edit distance DP, column by column
+                std::optional<alignment_end_range> expected_end_range = std::nullopt;
+                std::vector<size_t> column(query_length + 1);
+                for (size_t row = 0; row <= query_length; ++row) {
+                    column[row] = row;
+                }
+
+                for (size_t j = 1; j <= reference.size(); ++j) {
+                    size_t diagonal = column[0];
+                    column[0] = 0;
+                    for (size_t row = 1; row <= query_length; ++row) {
+                        size_t const up = column[row];
+                        column[row] = std::min({
+                            diagonal + (query[row - 1] == reference[j - 1] ? 0 : 1),
+                            up + 1,
+                            column[row - 1] + 1
+                        });
+                        diagonal = up;
+                    }
+
+                    size_t const score = column[query_length];
+                    if (score <= num_allowed_errors) {
+                        size_t const end_minus_errors = j >= score ? j - score : 0;
+                        if (!expected_end_range.has_value()) {
+                            expected_end_range = alignment_end_range {
+                                .min_end_position = j,
+                                .max_end_position_minus_num_errors = end_minus_errors
+                            };
+                        } else {
+                            expected_end_range->max_end_position_minus_num_errors = std::max(
+                                expected_end_range->max_end_position_minus_num_errors,
+                                end_minus_errors
+                            );
+                        }
+                    }
+                }
+
+                auto const end_range = alignment_end_range_of(reference_spans[i], pattern, num_allowed_errors);
+
+                ASSERT_EQ(end_ranges[i].has_value(), expected_end_range.has_value());
+                ASSERT_EQ(end_range.has_value(), expected_end_range.has_value());
+                if (expected_end_range.has_value()) {
+                    EXPECT_EQ(end_ranges[i]->min_end_position, expected_end_range->min_end_position);
+                    EXPECT_EQ(
+                        end_ranges[i]->max_end_position_minus_num_errors,
+                        expected_end_range->max_end_position_minus_num_errors
+                    );
+                    EXPECT_EQ(end_range->min_end_position, expected_end_range->min_end_position);
+                    EXPECT_EQ(
+                        end_range->max_end_position_minus_num_errors,
+                        expected_end_range->max_end_position_minus_num_errors
+                    );
+                }
+            }
+        }
+    }
+}
+
+TEST(bit_parallel_alignment, exact_matches_of_multiple_blocks) {
+    using namespace bit_parallel_alignment;
+
+    // the band drops the upper block right when the lower block is needed for the diagonal of the exact match
+    for (size_t query_length : { 65ul, 77ul, 128ul, 130ul }) {
+        std::vector<uint8_t> query(query_length);
+        for (size_t i = 0; i < query_length; ++i) {
+            query[i] = static_cast<uint8_t>(1 + (i * 7 + i / 3) % 4);
+        }
+        std::vector<uint8_t> const reverse_query(query.rbegin(), query.rend());
+        query_pattern const pattern(query);
+        query_pattern const reverse_pattern(reverse_query);
+
+        std::vector<uint8_t> reference{ 4 };
+        reference.insert(reference.end(), query.begin(), query.end());
+        std::vector<std::span<const uint8_t>> const reference_spans{ reference, reference };
+
+        for (size_t num_allowed_errors = 0; num_allowed_errors <= 2; ++num_allowed_errors) {
+            EXPECT_TRUE(alignment_exists(reference, pattern, num_allowed_errors));
+            EXPECT_EQ(alignments_exist(reference_spans, pattern, num_allowed_errors), std::vector<bool>(2, true));
+
+            auto const end = best_alignment_end(reference, pattern, num_allowed_errors, sequence_direction::forward);
+            ASSERT_TRUE(end.has_value());
+            EXPECT_EQ(end->num_errors, 0ul);
+            EXPECT_EQ(end->end_position, reference.size());
+
+            auto const start = best_alignment_end(
+                reference, reverse_pattern, num_allowed_errors, sequence_direction::reverse
+            );
+            ASSERT_TRUE(start.has_value());
+            EXPECT_EQ(start->num_errors, 0ul);
+            EXPECT_EQ(start->end_position, query_length);
+
+            auto const alignment = best_alignment_with_cigar(reference, pattern, num_allowed_errors);
+            ASSERT_TRUE(alignment.has_value());
+            EXPECT_EQ(alignment->num_errors, 0ul);
+            EXPECT_EQ(alignment->start_position, 1ul);
+        }
+    }
+}
+
+TEST(bit_parallel_alignment, windowed_traceback_matches_full_traceback) {
+    using namespace bit_parallel_alignment;
+
+    std::mt19937 random_engine(13);
+    std::uniform_int_distribution<int> rank_distribution(1, 4);
+
+    for (size_t query_length : { 10ul, 64ul, 65ul, 130ul, 300ul }) {
+        std::vector<uint8_t> query(query_length);
+        std::ranges::generate(query, [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); });
+        std::vector<uint8_t> const reverse_query(query.rbegin(), query.rend());
+
+        // the reference contains two mutated copies of the query
+        std::vector<uint8_t> reference(3 * query_length);
+        std::ranges::generate(reference, [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); });
+        for (size_t i = 0; i < query_length; ++i) {
+            reference[query_length / 2 + i] = i % 11 == 0 ? 5 : query[i];
+            reference[2 * query_length - 3 + i] = i % 23 == 0 ? 5 : query[i];
+        }
+
+        query_pattern const pattern(query);
+        query_pattern const reverse_pattern(reverse_query);
+
+        for (size_t num_allowed_errors = 0; num_allowed_errors < query_length; num_allowed_errors += 1 + num_allowed_errors) {
+            auto const expected_alignment = best_alignment_with_cigar(reference, pattern, num_allowed_errors);
+            auto const alignment = best_alignment_with_cigar(reference, pattern, reverse_pattern, num_allowed_errors);
+
+            ASSERT_EQ(alignment.has_value(), expected_alignment.has_value());
+            if (alignment.has_value()) {
+                EXPECT_EQ(alignment->num_errors, expected_alignment->num_errors);
+                EXPECT_EQ(alignment->start_position, expected_alignment->start_position);
+                EXPECT_TRUE(alignment->cigar == expected_alignment->cigar);
+            }
+        }
+    }
+}
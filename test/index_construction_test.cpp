@@ -0,0 +1,85 @@
+#include <fmindex.hpp>
+#include <index_construction.hpp>
+#include <input.hpp>
+
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(index_construction, build_index_from_packed_references) {
+    std::vector<std::vector<uint8_t>> const rank_sequences {
+        { 1,1,2,3,4,4,2,1,3,3,4,2,2,1 },
+        { 4,3,2,1,5,5,5,1,2 }
+    };
+
+    std::vector<input::reference_record> records;
+    for (size_t i = 0; i < rank_sequences.size(); ++i) {
+        records.emplace_back("", packed_rank_sequence(rank_sequences[i]), i);
+    }
+    input::references const references { .records = std::move(records), .total_sequence_length = 23 };
+
+    EXPECT_EQ(index_construction::unpack_references(references), rank_sequences);
+
+    auto const config = index_construction::index_config {
+        .occurrence_table = occurrence_table_variant::epr_v2_8,
+        .suffix_array_sampling_rate = 2,
+        .min_stripped_n_run_length = 3,
+        .num_threads = 1
+    };
+    auto const index = index_construction::build_index(references, config);
+
+    ASSERT_EQ(occurrence_table_variant_of(index), occurrence_table_variant::epr_v2_8);
+    auto const& typed_index = std::get<fmindex_epr_v2_8>(index);
+    auto const expected_index = fmindex_epr_v2_8(rank_sequences, 2, 1, 3);
+    EXPECT_EQ(typed_index.size(), expected_index.size());
+    EXPECT_EQ(typed_index.get_fragments().size(), 3);
+
+    auto const kmer_table = index_construction::build_kmer_table(index, 2);
+    EXPECT_EQ(kmer_table.kmer_length(), 2);
+}
+
+TEST(index_construction, partition_references_into_shards) {
+    std::vector<std::vector<uint8_t>> const rank_sequences {
+        { 1,2,3,4 },
+        { 4,3,2 },
+        { 1,1,1,1,1,1,1,1,1,1 },
+        { 2,2 },
+        { 3 }
+    };
+
+    std::vector<input::reference_record> records;
+    for (size_t i = 0; i < rank_sequences.size(); ++i) {
+        records.emplace_back("", packed_rank_sequence(rank_sequences[i]), i);
+    }
+    input::references const references { .records = std::move(records), .total_sequence_length = 20 };
+
+    auto const ranges_of = [] (std::vector<index_shard_range> const& shard_ranges) {
+        std::vector<std::tuple<size_t, size_t>> ranges{};
+        for (auto const& shard_range : shard_ranges) {
+            ranges.emplace_back(shard_range.first_reference_id, shard_range.num_references);
+        }
+
+        return ranges;
+    };
+
+    // the third reference is longer than a shard and gets a shard of its own
+    auto const shard_ranges = index_construction::partition_references_into_shards(references, 8);
+    EXPECT_EQ(
+        ranges_of(shard_ranges),
+        (std::vector<std::tuple<size_t, size_t>>{ { 0, 2 }, { 2, 1 }, { 3, 2 } })
+    );
+
+    EXPECT_EQ(
+        ranges_of(index_construction::partition_references_into_shards(references, 100)),
+        (std::vector<std::tuple<size_t, size_t>>{ { 0, 5 } })
+    );
+
+    EXPECT_EQ(
+        index_construction::unpack_references(references, shard_ranges[2]),
+        (std::vector<std::vector<uint8_t>>{ { 2,2 }, { 3 } })
+    );
+}
@@ -1,4 +1,16 @@
+#include <fmindex.hpp>
 #include <input.hpp>
+#include <kmer_cursor_table.hpp>
+#include <output.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
 
 #include <gtest/gtest.h>
 
@@ -24,4 +36,102 @@ TEST(input, chars_to_rank_sequence_invald_chars) {
     std::string const chars_with_invalid = "ACGTacgtW3>"; // 'U' becomes 4, just like 'T'. NOt sure if this is good behavior from ivsigma
     std::vector<uint8_t> const expected_rank_sequence{ 1,2,3,4,1,2,3,4,5,5,5 };
     EXPECT_EQ(input::internal::chars_to_rank_sequence(chars_with_invalid), expected_rank_sequence);
-}
\ No newline at end of file
+}
+
+TEST(input, load_index_with_recorded_occurrence_table) {
+    std::vector<std::vector<uint8_t>> const references {
+        { 1,1,2,3,4,4,2,1,3,3,4,2,2,1 },
+        { 4,3,2,1,5,5,1,2 }
+    };
+
+    auto const index_path = std::filesystem::temp_directory_path() / "floxer_input_test_index.flxi";
+
+    for (auto const variant : {
+        occurrence_table_variant::epr_v2_8,
+        occurrence_table_variant::epr_v2_16,
+        occurrence_table_variant::epr_v2_32,
+        occurrence_table_variant::epr_v2_16_dna4
+    }) {
+        auto const index = build_fmindex(variant, references, 2, 1);
+        kmer_cursor_table const kmer_table = std::visit([] (auto const& typed_index) {
+            return kmer_cursor_table(typed_index, 2);
+        }, index);
+
+        output::save_index(index, kmer_table, index_path);
+
+        kmer_cursor_table loaded_kmer_table{};
+        auto const loaded_index = input::load_index(index_path, loaded_kmer_table);
+
+        EXPECT_EQ(occurrence_table_variant_of(loaded_index), variant);
+        EXPECT_EQ(loaded_kmer_table.kmer_length(), 2);
+        auto const size_of = [] (auto const& typed_index) { return typed_index.size(); };
+        EXPECT_EQ(std::visit(size_of, loaded_index), std::visit(size_of, index));
+    }
+
+    // the fragment table of an index with removed runs of N is stored with the index
+    {
+        auto const index = build_fmindex(occurrence_table_variant::epr_v2_16, references, 2, 1, 2);
+        output::save_index(index, kmer_cursor_table{}, index_path);
+
+        auto const loaded_index = input::load_index(index_path);
+        auto const& fragments = std::get<fmindex_epr_v2_16>(loaded_index).get_fragments();
+        ASSERT_EQ(fragments.size(), 3);
+        EXPECT_EQ(std::make_tuple(fragments[2].reference_id, fragments[2].reference_position), std::make_tuple(1, 6));
+    }
+
+    // index files of older versions contain only the index with the default table
+    {
+        fmindex const index(references, 2, 1);
+        auto ofs = std::ofstream(index_path, std::ios::binary);
+        auto archive = cereal::BinaryOutputArchive{ofs};
+        archive(static_cast<fmindex::base_index_t const&>(index));
+    }
+
+    auto const loaded_index = input::load_index(index_path);
+    EXPECT_EQ(occurrence_table_variant_of(loaded_index), occurrence_table_variant::epr_v2_16);
+
+    std::filesystem::remove(index_path);
+}
+
+TEST(input, save_and_load_references) {
+    auto const references_path = input::references_path_of_index(
+        std::filesystem::temp_directory_path() / "floxer_input_test_index.flxi"
+    );
+    EXPECT_EQ(references_path.filename(), "floxer_input_test_index.flxi.references");
+
+    std::filesystem::remove(references_path);
+    EXPECT_FALSE(input::load_references(references_path).has_value());
+
+    std::vector<input::reference_record> records;
+    records.emplace_back("first", packed_rank_sequence{ 1,2,3,4,5,5,1 }, 0);
+    records.emplace_back("second", packed_rank_sequence{ 4,3,2,1 }, 1);
+    input::references const references { .records = std::move(records), .total_sequence_length = 11 };
+
+    output::save_references(references, references_path);
+    auto const loaded_references = input::load_references(references_path);
+
+    ASSERT_TRUE(loaded_references.has_value());
+    EXPECT_EQ(loaded_references->total_sequence_length, references.total_sequence_length);
+    ASSERT_EQ(loaded_references->records.size(), references.records.size());
+    for (size_t i = 0; i < references.records.size(); ++i) {
+        EXPECT_EQ(loaded_references->records[i].id, references.records[i].id);
+        EXPECT_EQ(loaded_references->records[i].rank_sequence.unpack(), references.records[i].rank_sequence.unpack());
+        EXPECT_EQ(loaded_references->records[i].internal_id, references.records[i].internal_id);
+    }
+
+    // the file is written to a temporary file first and then renamed
+    auto temporary_path = references_path;
+    temporary_path += ".tmp";
+    EXPECT_FALSE(std::filesystem::exists(temporary_path));
+
+    // a truncated file can't be loaded, the caller reads the reference file instead
+    std::filesystem::resize_file(references_path, std::filesystem::file_size(references_path) - 3);
+    EXPECT_THROW(input::load_references(references_path), std::runtime_error);
+
+    // a failed save doesn't leave a file behind
+    auto const unwritable_path = std::filesystem::temp_directory_path() / "floxer_missing_directory" / "references";
+    output::save_references(references, unwritable_path);
+    EXPECT_FALSE(std::filesystem::exists(unwritable_path));
+
+    std::filesystem::remove(references_path);
+}
@@ -0,0 +1,53 @@
+#include <fmindex.hpp>
+#include <kmer_cursor_table.hpp>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(kmer_cursor_table, cursors_match_searched_cursors) {
+    std::vector<std::vector<uint8_t>> const references {
+        { 1,1,1,1,2,2,3,4,1,2,3,4,4,4,2,1 },
+        { 4,3,2,1,5,5,1,2 }
+    };
+
+    size_t const suffix_array_sampling_rate = 4;
+    size_t const num_threads = 1;
+    fmindex const index(references, suffix_array_sampling_rate, num_threads);
+
+    size_t const kmer_length = 3;
+    kmer_cursor_table const table(index, kmer_length);
+    EXPECT_EQ(table.kmer_length(), kmer_length);
+    EXPECT_FALSE(table.empty());
+
+    for (uint8_t first = 1; first <= 4; ++first) {
+        for (uint8_t second = 1; second <= 4; ++second) {
+            for (uint8_t third = 1; third <= 4; ++third) {
+                std::vector<uint8_t> const kmer{ first, second, third };
+
+                auto expected_cursor = fmindex_cursor(index);
+                for (uint8_t const rank : kmer) {
+                    expected_cursor = expected_cursor.extendRight(rank);
+                }
+
+                auto const cursor = table.cursor_of(index, kmer);
+                ASSERT_TRUE(cursor.has_value());
+                EXPECT_EQ(cursor->count(), expected_cursor.count());
+
+                if (!expected_cursor.empty()) {
+                    EXPECT_EQ(cursor->lb, expected_cursor.lb);
+                    EXPECT_EQ(cursor->lbRev, expected_cursor.lbRev);
+
+                    // the cursor from the table can be extended like the searched one
+                    EXPECT_EQ(cursor->extendLeft(4).count(), expected_cursor.extendLeft(4).count());
+                    EXPECT_EQ(cursor->extendRight(2).count(), expected_cursor.extendRight(2).count());
+                }
+            }
+        }
+    }
+
+    std::vector<uint8_t> const kmer_with_n{ 1, 5, 1 };
+    EXPECT_FALSE(table.cursor_of(index, kmer_with_n).has_value());
+
+    EXPECT_TRUE(kmer_cursor_table{}.empty());
+}
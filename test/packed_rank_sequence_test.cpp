@@ -0,0 +1,48 @@
+#include <packed_rank_sequence.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(packed_rank_sequence, unpack) {
+    std::vector<uint8_t> const rank_sequence{ 5,5,1,2,3,4,5,5,5,4,3,2,1,0,5,1,1,2,2,3,3,4,4,1,2,3,4,1,2,3,4,1,2,3,4,5 };
+    packed_rank_sequence const packed(rank_sequence);
+
+    EXPECT_EQ(packed.size(), rank_sequence.size());
+    // the sentinel and the N around it are separate runs, because their ranks differ
+    EXPECT_EQ(packed.num_exception_runs(), 5);
+    EXPECT_EQ(packed.unpack(), rank_sequence);
+
+    EXPECT_TRUE(packed_rank_sequence{}.unpack().empty());
+    EXPECT_EQ((packed_rank_sequence{ 1,2,3,4 }).unpack(), (std::vector<uint8_t>{ 1,2,3,4 }));
+}
+
+TEST(packed_rank_sequence, unpack_windows) {
+    std::mt19937 random_generator(42);
+    std::uniform_int_distribution<int> rank_distribution(1, 5);
+
+    // longer than some words, with runs of N that cross the borders of the words
+    std::vector<uint8_t> rank_sequence(200);
+    for (auto& rank : rank_sequence) {
+        rank = static_cast<uint8_t>(rank_distribution(random_generator));
+    }
+    std::fill(rank_sequence.begin() + 60, rank_sequence.begin() + 70, 5);
+
+    packed_rank_sequence const packed(rank_sequence);
+
+    for (size_t begin = 0; begin <= rank_sequence.size(); begin += 7) {
+        for (size_t length = 0; begin + length <= rank_sequence.size(); length += 13) {
+            std::vector<uint8_t> window(length);
+            packed.unpack_into(begin, window);
+
+            EXPECT_EQ(window, std::vector<uint8_t>(
+                rank_sequence.begin() + begin,
+                rank_sequence.begin() + begin + length
+            )) << "begin " << begin << ", length " << length;
+        }
+    }
+}
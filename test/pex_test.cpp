@@ -1,6 +1,10 @@
 #include <pex.hpp>
 #include <search.hpp>
 
+#include <algorithm>
+#include <ranges>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include <iostream>
 
@@ -141,3 +145,46 @@ TEST(pex, generate_seeds_from_bottom_up) {
     };
     EXPECT_EQ(seeds, expected_seeds);
 }
+
+TEST(pex, mirrored) {
+    // the recursive building puts the remainder of the query length into the rightmost leaf
+    pex::pex_tree_config const config(
+        31,
+        6,
+        1,
+        pex::pex_tree_build_strategy::recursive
+    );
+
+    auto const tree = pex::pex_tree(config);
+    auto const mirrored_tree = tree.mirrored();
+
+    auto const& leaves = tree.get_leaves();
+    auto const& mirrored_leaves = mirrored_tree.get_leaves();
+    ASSERT_EQ(leaves.size(), mirrored_leaves.size());
+    ASSERT_EQ(tree.get_inner_nodes().size(), mirrored_tree.get_inner_nodes().size());
+
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        EXPECT_EQ(mirrored_leaves[i].parent_id, leaves[i].parent_id);
+        EXPECT_EQ(mirrored_leaves[i].num_errors, leaves[i].num_errors);
+        EXPECT_EQ(mirrored_leaves[i].query_index_from, 30 - leaves[i].query_index_to);
+        EXPECT_EQ(mirrored_leaves[i].query_index_to, 30 - leaves[i].query_index_from);
+    }
+
+    EXPECT_EQ(mirrored_tree.root().query_index_from, 0);
+    EXPECT_EQ(mirrored_tree.root().query_index_to, 30);
+
+    std::vector<uint8_t> query(31);
+    for (size_t i = 0; i < query.size(); ++i) {
+        query[i] = i % 4;
+    }
+    std::vector<uint8_t> const reversed_query(query.rbegin(), query.rend());
+
+    auto const seeds = tree.generate_seeds(query, 1);
+    auto const mirrored_seeds = mirrored_tree.generate_seeds(reversed_query, 1);
+    ASSERT_EQ(seeds.size(), mirrored_seeds.size());
+
+    for (size_t i = 0; i < seeds.size(); ++i) {
+        EXPECT_EQ(mirrored_seeds[i].pex_leaf_index, seeds[i].pex_leaf_index);
+        EXPECT_TRUE(std::ranges::equal(mirrored_seeds[i].sequence, seeds[i].sequence | std::views::reverse));
+    }
+}
@@ -1,6 +1,20 @@
 #include <fmindex.hpp>
+#include <interleaved_search.hpp>
+#include <pex.hpp>
 #include <search.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <span>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 TEST(search, search_seeds) {
@@ -9,10 +23,12 @@ TEST(search, search_seeds) {
         .max_num_anchors_soft = 10,
         .anchor_group_order = search::anchor_group_order_t::count_first,
         .anchor_choice_strategy = search::anchor_choice_strategy_t::round_robin,
-        .erase_useless_anchors = true
+        .erase_useless_anchors = true,
+        .interleaved_seed_search = false
     };
 
-    search::internal::search_scheme_cache scheme_cache;
+    search::search_scheme_cache scheme_cache;
+    kmer_cursor_table const kmer_table{};
 
     std::vector<std::vector<uint8_t>> const references {
         { 1,1,1,1,1,1,2,2,2,2,2,2,3,3,3,3,3,3,4,4,4,4,4,4 },
@@ -22,7 +38,8 @@ TEST(search, search_seeds) {
 
     size_t const suffix_array_sampling_rate  = 4;
     size_t const num_threads = 4;
-    fmindex index(
+    fmindex_variant const index = build_fmindex(
+        occurrence_table_variant::epr_v2_16,
         references,
         suffix_array_sampling_rate,
         num_threads
@@ -30,6 +47,8 @@ TEST(search, search_seeds) {
 
     search::searcher searcher {
         .index = index,
+        .scheme_cache = scheme_cache,
+        .kmer_table = kmer_table,
         .num_reference_sequences = num_reference_sequences,
         .config = config
     };
@@ -182,3 +201,874 @@ TEST(search, erase_useless_anchors) {
 
     EXPECT_EQ(anchors, expected_anchors);
 }
+
+TEST(search, search_scheme_cache) {
+    search::search_scheme_cache scheme_cache;
+
+    std::vector<search::search_scheme_key> const keys{ { 10, 1 }, { 20, 2 }, { 10, 1 } };
+    scheme_cache.prewarm(keys);
+    EXPECT_EQ(scheme_cache.num_prewarmed_schemes(), 2);
+
+    auto const& prewarmed_scheme = scheme_cache.get(10, 1);
+    EXPECT_EQ(&prewarmed_scheme, &scheme_cache.get(10, 1));
+    EXPECT_EQ(prewarmed_scheme.size(), search::internal::create_search_scheme(10, 1).size());
+
+    // all threads get the same scheme that was created on demand
+    std::vector<search_schemes::Scheme const*> schemes_of_threads(8, nullptr);
+    std::vector<std::thread> threads{};
+    for (size_t i = 0; i < schemes_of_threads.size(); ++i) {
+        threads.emplace_back([&scheme_cache, &schemes_of_threads, i] () {
+            schemes_of_threads[i] = &scheme_cache.get(30, 2);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (auto const scheme : schemes_of_threads) {
+        EXPECT_EQ(scheme, &scheme_cache.get(30, 2));
+    }
+    EXPECT_EQ(scheme_cache.num_prewarmed_schemes(), 2);
+}
+
+TEST(search, merge_overlapping_anchor_groups) {
+    using search::internal::anchor_group;
+
+    std::vector<anchor_group> const anchor_groups {
+        anchor_group { .suffix_array_begin = 0, .suffix_array_end = 10, .num_errors = 2 },
+        anchor_group { .suffix_array_begin = 5, .suffix_array_end = 15, .num_errors = 1 },
+        anchor_group { .suffix_array_begin = 20, .suffix_array_end = 25, .num_errors = 0 },
+        anchor_group { .suffix_array_begin = 22, .suffix_array_end = 23, .num_errors = 0 },
+        anchor_group { .suffix_array_begin = 40, .suffix_array_end = 50, .num_errors = 1 },
+        anchor_group { .suffix_array_begin = 42, .suffix_array_end = 45, .num_errors = 0 },
+        anchor_group { .suffix_array_begin = 30, .suffix_array_end = 31, .num_errors = 3 },
+        anchor_group { .suffix_array_begin = 31, .suffix_array_end = 33, .num_errors = 3 }
+    };
+
+    std::vector<anchor_group> const expected_merged_groups {
+        anchor_group { .suffix_array_begin = 0, .suffix_array_end = 5, .num_errors = 2 },
+        anchor_group { .suffix_array_begin = 5, .suffix_array_end = 15, .num_errors = 1 },
+        anchor_group { .suffix_array_begin = 20, .suffix_array_end = 25, .num_errors = 0 },
+        anchor_group { .suffix_array_begin = 30, .suffix_array_end = 33, .num_errors = 3 },
+        anchor_group { .suffix_array_begin = 40, .suffix_array_end = 42, .num_errors = 1 },
+        anchor_group { .suffix_array_begin = 42, .suffix_array_end = 45, .num_errors = 0 },
+        anchor_group { .suffix_array_begin = 45, .suffix_array_end = 50, .num_errors = 1 }
+    };
+
+    auto const merged_groups = search::internal::merge_overlapping_anchor_groups(anchor_groups);
+
+    ASSERT_EQ(merged_groups.size(), expected_merged_groups.size());
+    for (size_t i = 0; i < merged_groups.size(); ++i) {
+        EXPECT_EQ(merged_groups[i].suffix_array_begin, expected_merged_groups[i].suffix_array_begin);
+        EXPECT_EQ(merged_groups[i].suffix_array_end, expected_merged_groups[i].suffix_array_end);
+        EXPECT_EQ(merged_groups[i].num_errors, expected_merged_groups[i].num_errors);
+    }
+}
+
+TEST(search, locate_batch) {
+    std::vector<std::vector<uint8_t>> const references {
+        { 1,1,1,1,1,1,2,2,2,2,2,2,3,3,3,3,3,3,4,4,4,4,4,4 },
+        { 1,2,3,4,1,2,3,4,5,5,1,2 },
+        { 4,3,2,1 }
+    };
+
+    size_t const suffix_array_sampling_rate = 4;
+    size_t const num_threads = 1;
+    fmindex index(
+        references,
+        suffix_array_sampling_rate,
+        num_threads
+    );
+
+    // every row once (more rows than walks are interleaved at once), plus some duplicates
+    std::vector<size_t> rows{};
+    for (size_t row = 0; row < index.size(); ++row) {
+        rows.push_back(row);
+    }
+    for (size_t row = 0; row < index.size(); row += 3) {
+        rows.push_back(row);
+    }
+
+    auto const results = locate_batch(index, rows);
+
+    ASSERT_EQ(results.size(), rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        EXPECT_EQ(results[i], index.locate(rows[i]));
+    }
+
+    EXPECT_TRUE(locate_batch(index, std::vector<size_t>{}).empty());
+}
+
+TEST(search, dna4_index_locates_in_references) {
+    std::vector<std::vector<uint8_t>> const references {
+        { 5,5,1,2,3,4,5,5,5,4,3,2,1,5 },
+        { 5,5,5 },
+        { 1,1,2,2,5,3,3,4,4 }
+    };
+
+    size_t const suffix_array_sampling_rate = 3;
+    size_t const num_threads = 1;
+    fmindex_dna4 const index(references, suffix_array_sampling_rate, num_threads);
+
+    auto const& fragments = index.get_fragments();
+    ASSERT_EQ(fragments.size(), 4);
+    EXPECT_EQ(std::make_tuple(fragments[0].reference_id, fragments[0].reference_position), std::make_tuple(0, 2));
+    EXPECT_EQ(std::make_tuple(fragments[1].reference_id, fragments[1].reference_position), std::make_tuple(0, 9));
+    EXPECT_EQ(std::make_tuple(fragments[2].reference_id, fragments[2].reference_position), std::make_tuple(2, 0));
+    EXPECT_EQ(std::make_tuple(fragments[3].reference_id, fragments[3].reference_position), std::make_tuple(2, 5));
+
+    // the occurrences of all 2-mers are located in the references, none of them overlaps an N
+    for (uint8_t first = 1; first <= 4; ++first) {
+        for (uint8_t second = 1; second <= 4; ++second) {
+            auto const cursor = cursor_of_index_t<fmindex_dna4>(index).extendRight(first).extendRight(second);
+
+            std::vector<size_t> rows{};
+            for (size_t row = cursor.lb; row < cursor.lb + cursor.count(); ++row) {
+                rows.push_back(row);
+            }
+            auto const results = locate_batch(index, rows);
+
+            std::set<std::tuple<size_t, size_t>> located{};
+            for (size_t i = 0; i < rows.size(); ++i) {
+                EXPECT_EQ(results[i], index.locate(rows[i]));
+                located.emplace(results[i]);
+            }
+
+            std::set<std::tuple<size_t, size_t>> expected{};
+            for (size_t reference_id = 0; reference_id < references.size(); ++reference_id) {
+                auto const& reference = references[reference_id];
+                for (size_t position = 0; position + 1 < reference.size(); ++position) {
+                    if (reference[position] == first && reference[position + 1] == second) {
+                        expected.emplace(reference_id, position);
+                    }
+                }
+            }
+
+            EXPECT_EQ(located, expected);
+        }
+    }
+}
+
+TEST(search, stripped_n_runs_locate_in_references) {
+    std::vector<std::vector<uint8_t>> const references {
+        { 5,5,5,1,2,5,3,4,5,5,5,5,1,1,5,5 },
+        { 1,2,3,4 }
+    };
+    size_t const min_stripped_n_run_length = 3;
+
+    size_t const suffix_array_sampling_rate = 3;
+    size_t const num_threads = 1;
+    fmindex const index(references, suffix_array_sampling_rate, num_threads, min_stripped_n_run_length);
+
+    auto const& fragments = index.get_fragments();
+    ASSERT_EQ(fragments.size(), 3);
+    EXPECT_EQ(std::make_tuple(fragments[0].reference_id, fragments[0].reference_position), std::make_tuple(0, 3));
+    EXPECT_EQ(std::make_tuple(fragments[1].reference_id, fragments[1].reference_position), std::make_tuple(0, 12));
+    EXPECT_EQ(std::make_tuple(fragments[2].reference_id, fragments[2].reference_position), std::make_tuple(1, 0));
+
+    std::vector<std::vector<bool>> is_stripped(references.size());
+    for (size_t reference_id = 0; reference_id < references.size(); ++reference_id) {
+        auto const& reference = references[reference_id];
+        is_stripped[reference_id].resize(reference.size(), false);
+
+        for (size_t run_begin = 0; run_begin < reference.size(); ++run_begin) {
+            size_t run_end = run_begin;
+            while (run_end < reference.size() && reference[run_end] == 5) {
+                ++run_end;
+            }
+            if (run_end - run_begin >= min_stripped_n_run_length) {
+                std::fill(is_stripped[reference_id].begin() + run_begin, is_stripped[reference_id].begin() + run_end, true);
+            }
+            run_begin = std::max(run_begin, run_end);
+        }
+    }
+
+    // the occurrences of all 2-mers are located in the references, only the ones that overlap a long run of N are missing
+    for (uint8_t first = 1; first <= 5; ++first) {
+        for (uint8_t second = 1; second <= 5; ++second) {
+            auto const cursor = fmindex_cursor(index).extendRight(first).extendRight(second);
+
+            std::vector<size_t> rows{};
+            for (size_t row = cursor.lb; row < cursor.lb + cursor.count(); ++row) {
+                rows.push_back(row);
+            }
+            auto const results = locate_batch(index, rows);
+
+            std::set<std::tuple<size_t, size_t>> located{};
+            for (size_t i = 0; i < rows.size(); ++i) {
+                EXPECT_EQ(results[i], index.locate(rows[i]));
+                located.emplace(results[i]);
+            }
+
+            std::set<std::tuple<size_t, size_t>> expected{};
+            for (size_t reference_id = 0; reference_id < references.size(); ++reference_id) {
+                auto const& reference = references[reference_id];
+                for (size_t position = 0; position + 1 < reference.size(); ++position) {
+                    if (
+                        reference[position] == first && reference[position + 1] == second &&
+                        !is_stripped[reference_id][position] && !is_stripped[reference_id][position + 1]
+                    ) {
+                        expected.emplace(reference_id, position);
+                    }
+                }
+            }
+
+            EXPECT_EQ(located, expected) << "2-mer " << int{first} << int{second};
+        }
+    }
+
+    // without long runs of N, the texts of the index are the references
+    fmindex const unchanged_index(references, suffix_array_sampling_rate, num_threads, 5);
+    EXPECT_TRUE(unchanged_index.get_fragments().empty());
+    EXPECT_EQ(unchanged_index.size(), fmindex(references, suffix_array_sampling_rate, num_threads).size());
+}
+
+TEST(search, interleaved_search_seeds) {
+    std::vector<std::vector<uint8_t>> const references {
+        { 1,1,1,1,1,1,2,2,2,2,2,2,3,3,3,3,3,3,4,4,4,4,4,4 },
+        { 1,2,3,4,1,2,3,4 }
+    };
+
+    size_t const suffix_array_sampling_rate = 4;
+    size_t const num_threads = 1;
+    fmindex index(
+        references,
+        suffix_array_sampling_rate,
+        num_threads
+    );
+
+    std::vector<uint8_t> const query {
+        1,1,1,1,1,1, // matches exactly
+        2,2,2,3,2,2, // matches with 1 mismatch at reference 0, position 6
+        4,3,2,1,4,2  // does not match
+    };
+    std::span<const uint8_t> query_span(query);
+
+    std::vector<search::seed> const seeds{
+        search::seed { .sequence = query_span.subspan(0,6), .num_errors = 0, .query_position = 0, .pex_leaf_index = 0 },
+        search::seed { .sequence = query_span.subspan(6,6), .num_errors = 1, .query_position = 6, .pex_leaf_index = 1 },
+        search::seed { .sequence = query_span.subspan(12,6), .num_errors = 0, .query_position = 12, .pex_leaf_index = 2 }
+    };
+
+    search::search_scheme_cache scheme_cache;
+    std::vector<search_schemes::Scheme const*> search_schemes_of_seeds{};
+    for (auto const& seed : seeds) {
+        search_schemes_of_seeds.push_back(&scheme_cache.get(seed.sequence.size(), seed.num_errors));
+    }
+
+    kmer_cursor_table const empty_kmer_table{};
+    auto const results = interleaved_search::search_seeds(
+        index, empty_kmer_table, seeds, search_schemes_of_seeds, 100
+    );
+    ASSERT_EQ(results.size(), seeds.size());
+
+    auto const located_anchors = [&index] (interleaved_search::seed_search_result const& result) {
+        std::set<std::tuple<size_t, size_t, size_t>> anchors{};
+        for (auto const& group : search::internal::merge_overlapping_anchor_groups(result.anchor_groups)) {
+            for (size_t row = group.suffix_array_begin; row < group.suffix_array_end; ++row) {
+                auto const [reference_id, position] = index.locate(row);
+                anchors.emplace(reference_id, position, group.num_errors);
+            }
+        }
+        return anchors;
+    };
+
+    EXPECT_EQ(located_anchors(results[0]), (std::set<std::tuple<size_t, size_t, size_t>>{ { 0, 0, 0 } }));
+    EXPECT_TRUE(located_anchors(results[1]).contains({ 0, 6, 1 }));
+    EXPECT_TRUE(located_anchors(results[2]).empty());
+    EXPECT_EQ(results[2].total_num_raw_anchors, 0);
+
+    // the search of a seed stops once enough anchors were reported
+    auto const capped_results = interleaved_search::search_seeds(
+        index, empty_kmer_table, seeds, search_schemes_of_seeds, 1
+    );
+    EXPECT_GE(capped_results[1].total_num_raw_anchors, 1);
+    EXPECT_LT(capped_results[1].total_num_raw_anchors, results[1].total_num_raw_anchors);
+
+    // starting the exact parts of the searches from the k-mer table finds the same anchors
+    for (size_t kmer_length : { 1ul, 2ul, 3ul }) {
+        kmer_cursor_table const kmer_table(index, kmer_length);
+        auto const results_with_kmer_table = interleaved_search::search_seeds(
+            index, kmer_table, seeds, search_schemes_of_seeds, 100
+        );
+
+        for (size_t i = 0; i < seeds.size(); ++i) {
+            EXPECT_EQ(located_anchors(results_with_kmer_table[i]), located_anchors(results[i]));
+        }
+    }
+}
+
+TEST(search, interleaved_search_seeds_of_both_orientations) {
+    std::vector<std::vector<uint8_t>> const references {
+        { 1,1,2,3,4,4,2,1,3,3,4,2,2,1,4,3,1,2,4,4,3,1,1,2,3,4,2,2 },
+        { 4,3,2,1,1,2,3,4,4,4,2,1,3,2,4,1,1,3 }
+    };
+
+    size_t const suffix_array_sampling_rate = 4;
+    size_t const num_threads = 1;
+    fmindex index(
+        references,
+        suffix_array_sampling_rate,
+        num_threads
+    );
+
+    std::vector<uint8_t> const query {
+        2,3,4,4,2,1,3,  // matches reference 0 at position 2
+        3,1,2,1,4,4,2,  // its reverse complement matches reference 0 at position 20 with 1 mismatch
+        4,1,5,1,3,2,2   // contains an N
+    };
+    std::vector<uint8_t> reverse_complement_query(query.rbegin(), query.rend());
+    for (auto& rank : reverse_complement_query) {
+        rank = rank >= 1 && rank <= 4 ? 5 - rank : rank;
+    }
+
+    pex::pex_tree const pex_tree(pex::pex_tree_config(query.size(), 5, 1, pex::pex_tree_build_strategy::bottom_up));
+    auto const forward_seeds = pex_tree.generate_seeds(query, 1);
+    auto const reverse_complement_seeds = pex_tree.mirrored().generate_seeds(reverse_complement_query, 1);
+
+    search::search_scheme_cache scheme_cache;
+    auto const search_schemes_of = [&scheme_cache] (std::vector<search::seed> const& seeds) {
+        std::vector<search_schemes::Scheme const*> search_schemes_of_seeds{};
+        for (auto const& seed : seeds) {
+            search_schemes_of_seeds.push_back(&scheme_cache.get(seed.sequence.size(), seed.num_errors));
+        }
+        return search_schemes_of_seeds;
+    };
+
+    auto const located_anchors = [&index] (interleaved_search::seed_search_result const& result) {
+        std::set<std::tuple<size_t, size_t, size_t>> anchors{};
+        for (auto const& group : search::internal::merge_overlapping_anchor_groups(result.anchor_groups)) {
+            for (size_t row = group.suffix_array_begin; row < group.suffix_array_end; ++row) {
+                auto const [reference_id, position] = index.locate(row);
+                anchors.emplace(reference_id, position, group.num_errors);
+            }
+        }
+        return anchors;
+    };
+
+    // the joint search finds the same anchors as searching both orientations separately
+    for (size_t kmer_length : { 0ul, 2ul }) {
+        kmer_cursor_table const kmer_table(index, kmer_length);
+
+        auto const forward_results = interleaved_search::search_seeds(
+            index, kmer_table, forward_seeds, search_schemes_of(forward_seeds), 100
+        );
+        auto const reverse_complement_results = interleaved_search::search_seeds(
+            index, kmer_table, reverse_complement_seeds, search_schemes_of(reverse_complement_seeds), 100
+        );
+        auto const joint_results = interleaved_search::search_seeds_of_both_orientations(
+            index, kmer_table, forward_seeds, search_schemes_of(forward_seeds), 100
+        );
+
+        ASSERT_EQ(joint_results.forward.size(), forward_seeds.size());
+        ASSERT_EQ(joint_results.reverse_complement.size(), reverse_complement_seeds.size());
+
+        for (size_t i = 0; i < forward_seeds.size(); ++i) {
+            EXPECT_EQ(located_anchors(joint_results.forward[i]), located_anchors(forward_results[i]));
+            EXPECT_EQ(
+                located_anchors(joint_results.reverse_complement[i]),
+                located_anchors(reverse_complement_results[i])
+            );
+        }
+
+        EXPECT_TRUE(located_anchors(joint_results.forward[0]).contains({ 0, 2, 0 }));
+        EXPECT_TRUE(located_anchors(joint_results.reverse_complement[1]).contains({ 0, 20, 1 }));
+    }
+}
+
+// for every start position in the reference, the lowest edit distance of the seed to a substring starting there
+static std::vector<size_t> min_num_errors_of_start_positions(
+    std::span<const uint8_t> const reference,
+    std::span<const uint8_t> const seed
+) {
+    std::vector<size_t> min_num_errors(reference.size());
+
+    for (size_t start = 0; start < reference.size(); ++start) {
+        auto const text = reference.subspan(start);
+
+        // column of the dynamic programming matrix for the current text prefix, indexed by seed prefix length
+        std::vector<size_t> column(seed.size() + 1);
+        std::iota(column.begin(), column.end(), 0);
+        size_t best = column.back();
+
+        for (size_t j = 0; j < text.size(); ++j) {
+            size_t diagonal = column[0];
+            column[0] = j + 1;
+
+            for (size_t i = 1; i <= seed.size(); ++i) {
+                size_t const above = column[i];
+                column[i] = std::min({
+                    diagonal + (seed[i - 1] == text[j] ? 0 : 1),
+                    above + 1,
+                    column[i - 1] + 1
+                });
+                diagonal = above;
+            }
+
+            best = std::min(best, column.back());
+        }
+
+        min_num_errors[start] = best;
+    }
+
+    return min_num_errors;
+}
+
+TEST(search, interleaved_search_seeds_matches_brute_force) {
+    std::mt19937 random_engine(14);
+    std::uniform_int_distribution<int> rank_distribution(1, 4);
+    auto const random_rank = [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); };
+    auto const random_ranks = [&] (size_t const length) {
+        std::vector<uint8_t> ranks(length);
+        std::ranges::generate(ranks, random_rank);
+        return ranks;
+    };
+
+    std::vector<std::vector<uint8_t>> const references { random_ranks(300), random_ranks(250) };
+
+    size_t const suffix_array_sampling_rate = 4;
+    size_t const num_threads = 1;
+    fmindex index(
+        references,
+        suffix_array_sampling_rate,
+        num_threads
+    );
+
+    // seeds are copies of reference substrings with random substitutions, insertions and deletions,
+    // plus some random seeds that likely do not occur at all
+    size_t const seed_length = 16;
+    std::vector<std::vector<uint8_t>> seed_sequences{};
+    std::vector<size_t> num_errors_of_seeds{};
+
+    for (size_t num_errors = 0; num_errors <= 4; ++num_errors) {
+        for (size_t i = 0; i < 12; ++i) {
+            if (i % 4 == 3) {
+                seed_sequences.push_back(random_ranks(seed_length));
+                num_errors_of_seeds.push_back(num_errors);
+                continue;
+            }
+
+            auto const& reference = references[i % references.size()];
+            std::uniform_int_distribution<size_t> start_distribution(0, reference.size() - seed_length);
+            size_t const start = start_distribution(random_engine);
+            std::vector<uint8_t> sequence(
+                reference.begin() + start,
+                reference.begin() + start + seed_length
+            );
+
+            for (size_t e = 0; e < num_errors; ++e) {
+                std::uniform_int_distribution<size_t> position_distribution(0, sequence.size() - 1);
+                size_t const position = position_distribution(random_engine);
+
+                switch (random_engine() % 3) {
+                    case 0:
+                        sequence[position] = 1 + (sequence[position] % 4);
+                        break;
+                    case 1:
+                        sequence.insert(sequence.begin() + position, random_rank());
+                        break;
+                    default:
+                        sequence.erase(sequence.begin() + position);
+                        break;
+                }
+            }
+
+            seed_sequences.push_back(std::move(sequence));
+            num_errors_of_seeds.push_back(num_errors);
+        }
+    }
+
+    std::vector<search::seed> seeds{};
+    for (size_t i = 0; i < seed_sequences.size(); ++i) {
+        seeds.push_back(search::seed {
+            .sequence = seed_sequences[i],
+            .num_errors = num_errors_of_seeds[i],
+            .query_position = 0,
+            .pex_leaf_index = i
+        });
+    }
+
+    // different seed lengths and numbers of errors use different search schemes
+    search::search_scheme_cache scheme_cache;
+    std::vector<search_schemes::Scheme const*> search_schemes_of_seeds{};
+    for (auto const& seed : seeds) {
+        search_schemes_of_seeds.push_back(&scheme_cache.get(seed.sequence.size(), seed.num_errors));
+    }
+
+    for (size_t kmer_length : { 0ul, 4ul }) {
+        kmer_cursor_table const kmer_table(index, kmer_length);
+        auto const results = interleaved_search::search_seeds(
+            index, kmer_table, seeds, search_schemes_of_seeds, std::numeric_limits<size_t>::max()
+        );
+        ASSERT_EQ(results.size(), seeds.size());
+
+        for (size_t seed_index = 0; seed_index < seeds.size(); ++seed_index) {
+            auto const& seed = seeds[seed_index];
+            size_t const k = seed.num_errors;
+
+            // lowest number of errors of the located anchors of every reference position
+            std::vector<std::map<size_t, size_t>> located(references.size());
+            for (auto const& group : search::internal::merge_overlapping_anchor_groups(results[seed_index].anchor_groups)) {
+                for (size_t row = group.suffix_array_begin; row < group.suffix_array_end; ++row) {
+                    auto const [reference_id, position] = index.locate(row);
+                    auto const [iter, inserted] = located[reference_id].emplace(position, group.num_errors);
+                    if (!inserted) {
+                        iter->second = std::min(iter->second, group.num_errors);
+                    }
+                }
+            }
+
+            for (size_t reference_id = 0; reference_id < references.size(); ++reference_id) {
+                auto const& reference = references[reference_id];
+                auto const expected = min_num_errors_of_start_positions(reference, seed.sequence);
+                auto const& found = located[reference_id];
+                std::string const context = "seed " + std::to_string(seed_index) + ", reference " +
+                    std::to_string(reference_id) + ", k-mer length " + std::to_string(kmer_length);
+
+                // every anchor is an occurrence with at most the reported number of errors
+                for (auto const [position, num_errors] : found) {
+                    EXPECT_LE(num_errors, k) << context << ", position " << position;
+                    EXPECT_LE(expected[position], num_errors) << context << ", position " << position;
+                }
+
+                for (size_t position = 0; position < reference.size(); ++position) {
+                    size_t const num_errors = expected[position];
+                    bool const has_room_for_end_substitutions =
+                        position > k && position + seed.sequence.size() + 2 * k < reference.size();
+                    if (num_errors > k || !has_room_for_end_substitutions) {
+                        continue;
+                    }
+
+                    // an occurrence might only be found in a slightly shifted form (e.g. with a substitution
+                    // instead of an insertion at the end of the seed), but never with more errors
+                    bool const found_nearby = std::ranges::any_of(
+                        found.lower_bound(position - k),
+                        found.upper_bound(position + k),
+                        [num_errors] (auto const& anchor) { return anchor.second <= num_errors; }
+                    );
+                    EXPECT_TRUE(found_nearby) << context << ", position " << position;
+
+                    // if neighboring positions are worse, the occurrence has an optimal alignment that is searched
+                    if (num_errors < expected[position - 1] && num_errors < expected[position + 1]) {
+                        auto const iter = found.find(position);
+                        ASSERT_NE(iter, found.end()) << context << ", position " << position;
+                        EXPECT_EQ(iter->second, num_errors) << context << ", position " << position;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(search, hard_cap_excludes_repetitive_seeds) {
+    std::vector<std::vector<uint8_t>> const references {
+        { 1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,3,4,3,3,4,4,3,4 }
+    };
+
+    size_t const suffix_array_sampling_rate = 4;
+    size_t const num_threads = 1;
+    fmindex_variant const index = build_fmindex(
+        occurrence_table_variant::epr_v2_16,
+        references,
+        suffix_array_sampling_rate,
+        num_threads
+    );
+
+    std::vector<uint8_t> const query {
+        1,2,1,2,1,2, // occurs 10 times exactly and even more often with an error
+        3,4,3,3,4,4  // occurs once
+    };
+    std::span<const uint8_t> query_span(query);
+
+    std::vector<search::seed> const seeds{
+        search::seed { .sequence = query_span.subspan(0,6), .num_errors = 1, .query_position = 0, .pex_leaf_index = 0 },
+        search::seed { .sequence = query_span.subspan(6,6), .num_errors = 0, .query_position = 6, .pex_leaf_index = 1 }
+    };
+
+    search::search_scheme_cache scheme_cache;
+    kmer_cursor_table const kmer_table{};
+
+    for (bool const interleaved_seed_search : { false, true }) {
+        search::searcher searcher {
+            .index = index,
+            .scheme_cache = scheme_cache,
+            .kmer_table = kmer_table,
+            .num_reference_sequences = references.size(),
+            .config = search::search_config {
+                .max_num_anchors_hard = 5,
+                .max_num_anchors_soft = 5,
+                .anchor_group_order = search::anchor_group_order_t::count_first,
+                .anchor_choice_strategy = search::anchor_choice_strategy_t::round_robin,
+                .erase_useless_anchors = true,
+                .interleaved_seed_search = interleaved_seed_search
+            }
+        };
+
+        auto const result = searcher.search_seeds(seeds);
+
+        EXPECT_EQ(result.num_fully_excluded_seeds, 1);
+        ASSERT_EQ(result.anchors_by_seed.size(), 2);
+        EXPECT_EQ(result.anchors_by_seed[0].num_kept_raw_anchors, 0);
+        EXPECT_TRUE(result.anchors_by_seed[0].anchors_by_reference.empty());
+        EXPECT_EQ(result.anchors_by_seed[1].num_kept_raw_anchors, 1);
+    }
+}
+
+TEST(search, search_seeds_with_all_occurrence_tables) {
+    std::vector<std::vector<uint8_t>> const references {
+        { 1,1,2,3,4,4,2,1,3,3,4,2,2,1,4,3,1,2,4,4,3,1,1,2,3,4,2,2 },
+        { 4,3,2,1,1,2,3,4,4,4,2,1,3,2,4,1,1,3 }
+    };
+
+    std::vector<uint8_t> const query {
+        2,3,4,4,2,1,3,
+        4,3,2,1,1,2,2
+    };
+    std::span<const uint8_t> query_span(query);
+
+    std::vector<search::seed> const seeds{
+        search::seed { .sequence = query_span.subspan(0,7), .num_errors = 0, .query_position = 0, .pex_leaf_index = 0 },
+        search::seed { .sequence = query_span.subspan(7,7), .num_errors = 1, .query_position = 7, .pex_leaf_index = 1 }
+    };
+
+    search::search_scheme_cache scheme_cache;
+    kmer_cursor_table const kmer_table{};
+
+    auto const search_with = [&] (occurrence_table_variant const variant) {
+        size_t const suffix_array_sampling_rate = 3;
+        size_t const num_threads = 1;
+        fmindex_variant const index = build_fmindex(variant, references, suffix_array_sampling_rate, num_threads);
+        EXPECT_EQ(occurrence_table_variant_of(index), variant);
+
+        search::searcher const searcher {
+            .index = index,
+            .scheme_cache = scheme_cache,
+            .kmer_table = kmer_table,
+            .num_reference_sequences = references.size(),
+            .config = search::search_config {
+                .max_num_anchors_hard = 100,
+                .max_num_anchors_soft = 100,
+                .anchor_group_order = search::anchor_group_order_t::count_first,
+                .anchor_choice_strategy = search::anchor_choice_strategy_t::full_groups,
+                .erase_useless_anchors = false,
+                .interleaved_seed_search = true
+            }
+        };
+
+        std::vector<std::set<std::tuple<size_t, size_t, size_t>>> anchors_by_seed{};
+        for (auto const& anchors_of_seed : searcher.search_seeds(seeds).anchors_by_seed) {
+            auto& anchors = anchors_by_seed.emplace_back();
+            for (auto const& anchors_of_reference : anchors_of_seed.anchors_by_reference) {
+                for (auto const& anchor : anchors_of_reference) {
+                    anchors.emplace(anchor.reference_id, anchor.reference_position, anchor.num_errors);
+                }
+            }
+        }
+
+        return anchors_by_seed;
+    };
+
+    auto const default_anchors_by_seed = search_with(occurrence_table_variant::epr_v2_16);
+    ASSERT_EQ(default_anchors_by_seed.size(), seeds.size());
+    EXPECT_TRUE(default_anchors_by_seed[0].contains({ 0, 2, 0 }));
+
+    EXPECT_EQ(search_with(occurrence_table_variant::epr_v2_8), default_anchors_by_seed);
+    EXPECT_EQ(search_with(occurrence_table_variant::epr_v2_32), default_anchors_by_seed);
+    // the references contain no N, so the DNA4 index finds the same anchors
+    EXPECT_EQ(search_with(occurrence_table_variant::epr_v2_16_dna4), default_anchors_by_seed);
+}
+
+TEST(search, merge_search_results_of_shards) {
+    std::vector<std::vector<uint8_t>> const references {
+        { 1,1,2,3,4,4,2,1,3,3,4,2,2,1,4,3,1,2,4,4,3,1,1,2,3,4,2,2 },
+        { 4,3,2,1,1,2,3,4,4,4,2,1,3,2,4,1,1,3 },
+        { 2,3,4,4,2,1,3,1,1,4,3,2,1,1,2,2,3 }
+    };
+
+    std::vector<uint8_t> const query {
+        2,3,4,4,2,1,3,
+        4,3,2,1,1,2,2
+    };
+    std::span<const uint8_t> query_span(query);
+
+    std::vector<search::seed> const seeds{
+        search::seed { .sequence = query_span.subspan(0,7), .num_errors = 0, .query_position = 0, .pex_leaf_index = 0 },
+        search::seed { .sequence = query_span.subspan(7,7), .num_errors = 1, .query_position = 7, .pex_leaf_index = 1 }
+    };
+
+    search::search_scheme_cache scheme_cache;
+    kmer_cursor_table const kmer_table{};
+    search::search_config const config {
+        .max_num_anchors_hard = 100,
+        .max_num_anchors_soft = 100,
+        .anchor_group_order = search::anchor_group_order_t::count_first,
+        .anchor_choice_strategy = search::anchor_choice_strategy_t::full_groups,
+        .erase_useless_anchors = false,
+        .interleaved_seed_search = true
+    };
+
+    size_t const suffix_array_sampling_rate = 3;
+    size_t const num_threads = 1;
+
+    auto const anchors_by_seed_of = [] (search::search_result const& result) {
+        std::vector<std::set<std::tuple<size_t, size_t, size_t>>> anchors_by_seed{};
+        for (auto const& anchors_of_seed : result.anchors_by_seed) {
+            auto& anchors = anchors_by_seed.emplace_back();
+            for (size_t reference_id = 0; reference_id < anchors_of_seed.anchors_by_reference.size(); ++reference_id) {
+                for (auto const& anchor : anchors_of_seed.anchors_by_reference[reference_id]) {
+                    EXPECT_EQ(anchor.reference_id, reference_id);
+                    anchors.emplace(anchor.reference_id, anchor.reference_position, anchor.num_errors);
+                }
+            }
+        }
+
+        return anchors_by_seed;
+    };
+
+    fmindex_variant const whole_index = build_fmindex(
+        occurrence_table_variant::epr_v2_16, references, suffix_array_sampling_rate, num_threads
+    );
+    search::searcher const whole_searcher {
+        .index = whole_index,
+        .scheme_cache = scheme_cache,
+        .kmer_table = kmer_table,
+        .num_reference_sequences = references.size(),
+        .config = config
+    };
+    auto const whole_result = whole_searcher.search_seeds(seeds);
+
+    // shard 0 contains the first reference, shard 1 the other two
+    std::vector<std::vector<uint8_t>> const references_of_shard_0(references.begin(), references.begin() + 1);
+    std::vector<std::vector<uint8_t>> const references_of_shard_1(references.begin() + 1, references.end());
+    fmindex_variant const index_of_shard_0 = build_fmindex(
+        occurrence_table_variant::epr_v2_16, references_of_shard_0, suffix_array_sampling_rate, num_threads
+    );
+    fmindex_variant const index_of_shard_1 = build_fmindex(
+        occurrence_table_variant::epr_v2_16, references_of_shard_1, suffix_array_sampling_rate, num_threads
+    );
+
+    std::vector<search::search_result> results_of_shards{};
+    std::vector<fmindex_variant const*> const indices_of_shards{ &index_of_shard_0, &index_of_shard_1 };
+    std::vector<size_t> const first_reference_ids_of_shards{ 0, 1 };
+    for (size_t shard_id = 0; shard_id < indices_of_shards.size(); ++shard_id) {
+        search::searcher const searcher {
+            .index = *indices_of_shards[shard_id],
+            .scheme_cache = scheme_cache,
+            .kmer_table = kmer_table,
+            .num_reference_sequences = references.size(),
+            .config = config,
+            .first_reference_id = first_reference_ids_of_shards[shard_id]
+        };
+        results_of_shards.emplace_back(searcher.search_seeds(seeds));
+    }
+
+    auto const merged_result = search::merge_search_results_of_shards(std::move(results_of_shards), config);
+
+    EXPECT_EQ(anchors_by_seed_of(merged_result), anchors_by_seed_of(whole_result));
+    EXPECT_EQ(merged_result.num_fully_excluded_seeds, whole_result.num_fully_excluded_seeds);
+    ASSERT_EQ(merged_result.anchors_by_seed.size(), whole_result.anchors_by_seed.size());
+    for (size_t seed_index = 0; seed_index < seeds.size(); ++seed_index) {
+        EXPECT_EQ(
+            merged_result.anchors_by_seed[seed_index].num_kept_raw_anchors,
+            whole_result.anchors_by_seed[seed_index].num_kept_raw_anchors
+        );
+    }
+}
+
+TEST(search, merge_search_results_of_shards_applies_caps) {
+    search::search_config const config {
+        .max_num_anchors_hard = 6,
+        .max_num_anchors_soft = 3,
+        .anchor_group_order = search::anchor_group_order_t::count_first,
+        .anchor_choice_strategy = search::anchor_choice_strategy_t::round_robin,
+        .erase_useless_anchors = false,
+        .interleaved_seed_search = false
+    };
+
+    // the result of a shard of the references 0 and 1, or the result of a seed that was excluded in it
+    auto const result_with = [] (
+        std::vector<search::anchor_t> const& anchors,
+        size_t const num_excluded_raw_anchors_by_soft_cap,
+        bool const is_excluded
+    ) {
+        std::vector<search::anchors_t> anchors_by_reference{};
+        if (!is_excluded) {
+            anchors_by_reference.resize(2);
+            for (auto const& anchor : anchors) {
+                anchors_by_reference[anchor.reference_id].push_back(anchor);
+            }
+        }
+
+        search::search_result result{};
+        result.anchors_by_seed.emplace_back(search::search_result::anchors_of_seed {
+            .num_kept_useful_anchors = anchors.size(),
+            .num_kept_raw_anchors = anchors.size(),
+            .num_excluded_raw_anchors_by_soft_cap = num_excluded_raw_anchors_by_soft_cap,
+            .anchors_by_reference = std::move(anchors_by_reference)
+        });
+        result.num_fully_excluded_seeds = is_excluded ? 1 : 0;
+
+        return result;
+    };
+
+    auto const anchor = [] (size_t const reference_id, size_t const position, size_t const num_errors) {
+        return search::anchor_t {
+            .pex_leaf_index = 0,
+            .reference_id = reference_id,
+            .reference_position = position,
+            .num_errors = num_errors
+        };
+    };
+
+    // a seed that is excluded in one shard also has too many anchors in all shards together
+    std::vector<search::search_result> partly_excluded{};
+    partly_excluded.emplace_back(result_with({}, 0, true));
+    partly_excluded.emplace_back(result_with({ anchor(1, 5, 0) }, 0, false));
+    auto const partly_excluded_merged = search::merge_search_results_of_shards(std::move(partly_excluded), config);
+    EXPECT_EQ(partly_excluded_merged.num_fully_excluded_seeds, 1);
+    EXPECT_TRUE(partly_excluded_merged.anchors_by_seed[0].anchors_by_reference.empty());
+    EXPECT_EQ(partly_excluded_merged.anchors_by_seed[0].num_kept_raw_anchors, 0);
+
+    // every shard is below the hard cap, but not all shards together
+    std::vector<search::search_result> above_hard_cap{};
+    above_hard_cap.emplace_back(result_with({ anchor(0, 1, 0), anchor(0, 7, 1) }, 2, false));
+    above_hard_cap.emplace_back(result_with({ anchor(1, 2, 0), anchor(1, 9, 1) }, 1, false));
+    auto const above_hard_cap_merged = search::merge_search_results_of_shards(std::move(above_hard_cap), config);
+    EXPECT_EQ(above_hard_cap_merged.num_fully_excluded_seeds, 1);
+    EXPECT_TRUE(above_hard_cap_merged.anchors_by_seed[0].anchors_by_reference.empty());
+
+    // every shard is below the soft cap, but not all shards together. The anchors with the fewest errors are kept
+    std::vector<search::search_result> above_soft_cap{};
+    above_soft_cap.emplace_back(result_with({ anchor(0, 1, 1), anchor(0, 7, 0) }, 0, false));
+    above_soft_cap.emplace_back(result_with({ anchor(1, 2, 2), anchor(1, 9, 0) }, 0, false));
+    auto const above_soft_cap_merged = search::merge_search_results_of_shards(std::move(above_soft_cap), config);
+    EXPECT_EQ(above_soft_cap_merged.num_fully_excluded_seeds, 0);
+
+    auto const& anchors_of_seed = above_soft_cap_merged.anchors_by_seed[0];
+    EXPECT_EQ(anchors_of_seed.num_kept_raw_anchors, 3);
+    EXPECT_EQ(anchors_of_seed.num_kept_useful_anchors, 3);
+    EXPECT_EQ(anchors_of_seed.num_excluded_raw_anchors_by_soft_cap, 1);
+    ASSERT_EQ(anchors_of_seed.anchors_by_reference.size(), 2);
+    ASSERT_EQ(anchors_of_seed.anchors_by_reference[0].size(), 2);
+    EXPECT_EQ(anchors_of_seed.anchors_by_reference[0][0].reference_position, 1);
+    EXPECT_EQ(anchors_of_seed.anchors_by_reference[0][1].reference_position, 7);
+    ASSERT_EQ(anchors_of_seed.anchors_by_reference[1].size(), 1);
+    EXPECT_EQ(anchors_of_seed.anchors_by_reference[1][0].reference_position, 9);
+
+    // more raw anchors than the soft cap, but only few useful ones. Nothing is removed and the counts stay the same
+    std::vector<search::search_result> few_useful{};
+    few_useful.emplace_back(result_with({ anchor(0, 1, 0) }, 0, false));
+    few_useful.emplace_back(result_with({ anchor(1, 2, 1) }, 0, false));
+    few_useful[0].anchors_by_seed[0].num_kept_raw_anchors = 3;
+    few_useful[1].anchors_by_seed[0].num_kept_raw_anchors = 2;
+    auto const few_useful_merged = search::merge_search_results_of_shards(std::move(few_useful), config);
+    EXPECT_EQ(few_useful_merged.num_fully_excluded_seeds, 0);
+
+    auto const& few_useful_anchors_of_seed = few_useful_merged.anchors_by_seed[0];
+    EXPECT_EQ(few_useful_anchors_of_seed.num_kept_raw_anchors, 5);
+    EXPECT_EQ(few_useful_anchors_of_seed.num_kept_useful_anchors, 2);
+    EXPECT_EQ(few_useful_anchors_of_seed.num_excluded_raw_anchors_by_soft_cap, 0);
+    ASSERT_EQ(few_useful_anchors_of_seed.anchors_by_reference.size(), 2);
+    EXPECT_EQ(few_useful_anchors_of_seed.anchors_by_reference[0].size(), 1);
+    EXPECT_EQ(few_useful_anchors_of_seed.anchors_by_reference[1].size(), 1);
+}
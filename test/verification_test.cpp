@@ -123,6 +123,127 @@ TEST(verification, verify) {
 }
 
 
+TEST(verification, batched_verify) {
+    input::references const references {
+        .records = {
+            input::reference_record {
+                .id = "",
+                .rank_sequence = {
+                4,2,3,4,3,4,4,4,3,2,
+                4,3,3,2,2,3,4,4,3,3,
+                4,3,2,2,1,4,3,3,4,2,
+                4,4,4,3,3,2,1,1,1,2,
+                3,4,4,3,2,4,4,2,1,4,
+                4,3,4,4,4,4,3,3,2,1, // query
+                2,3,4,3,2,1,2,3,4,3, // query
+                1,4,2,1,4,4,2,2,3,4, // query
+                3,3,2,1,4,4,1,1,1,2,
+                4,3,2,1,2,2,2,3,3,1
+                },
+                .internal_id = 0
+            }
+        },
+        .total_sequence_length = 100
+    };
+
+    std::vector<uint8_t> const query {
+        4,3,4,4,4,4,3,3,2,1,4, // insertion at end
+        2,3,4,3,2,1,2,3,4, // deletion at end
+        1,4,2,1,4,4,2,2,3,4
+    };
+
+    pex::pex_tree pex_tree(pex::pex_tree_config{
+        query.size(),
+        5,
+        1,
+        pex::pex_tree_build_strategy::bottom_up
+    });
+
+    // only the anchor at position 50 leads to an alignment
+    std::vector<search::anchor_t> const anchors {
+        { .pex_leaf_index = 0, .reference_id = 0, .reference_position = 3, .num_errors = 0 },
+        { .pex_leaf_index = 0, .reference_id = 0, .reference_position = 21, .num_errors = 0 },
+        { .pex_leaf_index = 0, .reference_id = 0, .reference_position = 50, .num_errors = 0 },
+        { .pex_leaf_index = 0, .reference_id = 0, .reference_position = 70, .num_errors = 0 }
+    };
+
+    auto verified_intervals = intervals::create_thread_safe_verified_intervals(
+        1, intervals::use_interval_optimization::on
+    );
+
+    verification::query_profile const profile(pex_tree, query);
+
+    alignment::query_alignments alignments(1);
+    statistics::search_and_alignment_statistics stats;
+
+    verification::batched_query_verifier verifier {
+        .pex_tree = pex_tree,
+        .anchors = anchors,
+        .pex_leaf_node = pex_tree.get_leaves().at(0),
+        .query = query,
+        .orientation = alignment::query_orientation::forward,
+        .references = references,
+        .kind = pex::verification_kind_t::hierarchical,
+        .verified_intervals_for_all_references = verified_intervals,
+        .extra_verification_ratio = 0.1,
+        .without_cigar = false,
+        .alignment_implementation = alignment::alignment_implementation::bit_parallel,
+        .alignments = alignments,
+        .stats = stats,
+        .profile = &profile
+    };
+
+    verifier.verify();
+
+    EXPECT_EQ(alignments.size(), 1);
+    auto const& alignment = alignments.to_reference(0).at(0);
+
+    EXPECT_EQ(alignment.cigar, seqan3::detail::parse_cigar("10=1I9=1D10="));
+    EXPECT_EQ(alignment.num_errors, 2);
+    EXPECT_EQ(alignment.start_in_reference, 50);
+}
+
+
+TEST(verification, query_profile) {
+    std::vector<uint8_t> query(300);
+    for (size_t i = 0; i < query.size(); ++i) {
+        query[i] = 1 + (i * i) % 5;
+    }
+
+    pex::pex_tree pex_tree(pex::pex_tree_config{
+        query.size(),
+        20,
+        2,
+        pex::pex_tree_build_strategy::bottom_up
+    });
+
+    verification::query_profile const profile(pex_tree, query);
+
+    auto nodes = pex_tree.get_inner_nodes();
+    nodes.push_back(pex_tree.root());
+
+    for (auto const& pex_node : nodes) {
+        auto const& pattern = profile.pattern_of(pex_node);
+        auto const query_span = std::span<const uint8_t>(query).subspan(
+            pex_node.query_index_from,
+            pex_node.length_of_query_span()
+        );
+        bit_parallel_alignment::query_pattern const expected_pattern(query_span);
+
+        EXPECT_EQ(pattern.length(), pex_node.length_of_query_span());
+        for (size_t block_index = 0; block_index < pattern.num_blocks(); ++block_index) {
+            for (uint8_t rank = 0; rank < bit_parallel_alignment::rank_alphabet_size; ++rank) {
+                EXPECT_EQ(pattern.match_mask(block_index, rank), expected_pattern.match_mask(block_index, rank));
+            }
+        }
+    }
+
+    std::vector<uint8_t> const reverse_query(query.rbegin(), query.rend());
+    bit_parallel_alignment::query_pattern const expected_reverse_pattern(reverse_query);
+    EXPECT_EQ(profile.reverse_root_pattern().match_mask(0, 3), expected_reverse_pattern.match_mask(0, 3));
+}
+
+
 TEST(verification, compute_reference_span_start_and_length) {
     search::anchor_t anchor {
         .pex_leaf_index = 0,
@@ -213,6 +334,8 @@ TEST(verification, try_to_align_pex_node_query_with_reference_span) {
         std::span(query),
         alignment::query_orientation::forward,
         false,
+        alignment::alignment_implementation::bit_parallel,
+        nullptr,
         alignments,
         stats
     );
@@ -236,6 +359,8 @@ TEST(verification, try_to_align_pex_node_query_with_reference_span) {
         std::span(query),
         alignment::query_orientation::forward,
         false,
+        alignment::alignment_implementation::bit_parallel,
+        nullptr,
         alignments,
         stats
     );
@@ -252,6 +377,8 @@ TEST(verification, try_to_align_pex_node_query_with_reference_span) {
         std::span(query),
         alignment::query_orientation::forward,
         false,
+        alignment::alignment_implementation::bit_parallel,
+        nullptr,
         alignments,
         stats
     );
@@ -259,3 +386,145 @@ TEST(verification, try_to_align_pex_node_query_with_reference_span) {
     EXPECT_EQ(outcome_expected_does_not_exist, alignment::alignment_outcome::no_adequate_alignment_exists);
     EXPECT_EQ(alignments.size(), 1);
 }
+
+TEST(verification, incremental_verify) {
+    input::references const references {
+        .records = {
+            input::reference_record {
+                .id = "",
+                .rank_sequence = {
+                4,2,3,4,3,4,4,4,3,2,
+                4,3,3,2,2,3,4,4,3,3,
+                4,3,2,2,1,4,3,3,4,2,
+                4,4,4,3,3,2,1,1,1,2,
+                3,4,4,3,2,4,4,2,1,4,
+                4,3,4,4,4,4,3,3,2,1, // query
+                2,3,4,3,2,1,2,3,4,3, // query
+                1,4,2,1,4,4,2,2,3,4, // query
+                3,3,2,1,4,4,1,1,1,2,
+                4,3,2,1,2,2,2,3,3,1
+                },
+                .internal_id = 0
+            }
+        },
+        .total_sequence_length = 100
+    };
+
+    std::vector<uint8_t> const query {
+        4,3,4,4,4,4,3,3,2,1,4, // insertion at end
+        2,3,4,3,2,1,2,3,4, // deletion at end
+        1,4,2,1,4,4,2,2,3,4
+    };
+
+    pex::pex_tree pex_tree(pex::pex_tree_config{
+        query.size(),
+        5,
+        0,
+        pex::pex_tree_build_strategy::bottom_up
+    });
+
+    std::vector<search::anchor_t> const anchors {
+        { .pex_leaf_index = 0, .reference_id = 0, .reference_position = 21, .num_errors = 0 },
+        { .pex_leaf_index = 0, .reference_id = 0, .reference_position = 50, .num_errors = 0 }
+    };
+
+    // the best alignment of the root contains the alignment of the child, so the scalar and the batched
+    // verification find the same alignment with and without the narrowing
+    for (bool const incremental : { false, true }) {
+        for (bool const batched : { false, true }) {
+            auto verified_intervals = intervals::create_thread_safe_verified_intervals(
+                1, intervals::use_interval_optimization::off
+            );
+
+            alignment::query_alignments alignments(1);
+            statistics::search_and_alignment_statistics stats;
+
+            if (batched) {
+                verification::batched_query_verifier verifier {
+                    .pex_tree = pex_tree,
+                    .anchors = anchors,
+                    .pex_leaf_node = pex_tree.get_leaves().at(0),
+                    .query = query,
+                    .orientation = alignment::query_orientation::forward,
+                    .references = references,
+                    .kind = pex::verification_kind_t::hierarchical,
+                    .verified_intervals_for_all_references = verified_intervals,
+                    .extra_verification_ratio = 0.1,
+                    .without_cigar = false,
+                    .alignment_implementation = alignment::alignment_implementation::bit_parallel,
+                    .alignments = alignments,
+                    .stats = stats,
+                    .incremental_verification = incremental
+                };
+
+                verifier.verify();
+            } else {
+                for (auto const& anchor : anchors) {
+                    verification::query_verifier verifier {
+                        .pex_tree = pex_tree,
+                        .anchor = anchor,
+                        .pex_leaf_node = pex_tree.get_leaves().at(0),
+                        .query = query,
+                        .orientation = alignment::query_orientation::forward,
+                        .reference = references.records.at(0),
+                        .kind = pex::verification_kind_t::hierarchical,
+                        .already_verified_intervals = verified_intervals.at(0),
+                        .extra_verification_ratio = 0.1,
+                        .without_cigar = false,
+                        .alignments = alignments,
+                        .stats = stats,
+                        .incremental_verification = incremental
+                    };
+
+                    verifier.verify();
+                }
+            }
+
+            EXPECT_EQ(alignments.size(), 1);
+            auto const& alignment = alignments.to_reference(0).at(0);
+
+            EXPECT_EQ(alignment.cigar, seqan3::detail::parse_cigar("10=1I9=1D10="));
+            EXPECT_EQ(alignment.num_errors, 2);
+            EXPECT_EQ(alignment.start_in_reference, 50);
+        }
+    }
+}
+
+TEST(verification, narrow_reference_span_to_verified_child) {
+    pex::pex_tree::node const pex_node {
+        .parent_id = pex::pex_tree::node::null_id,
+        .query_index_from = 0,
+        .query_index_to = 29,
+        .num_errors = 5
+    };
+
+    verification::internal::verified_child const child {
+        .pex_node = pex::pex_tree::node {
+            .parent_id = 0,
+            .query_index_from = 0,
+            .query_index_to = 9,
+            .num_errors = 1
+        },
+        .end_range = bit_parallel_alignment::alignment_end_range {
+            .min_end_position = 60,
+            .max_end_position_minus_num_errors = 59
+        }
+    };
+
+    verification::internal::span_config const reference_span_config {
+        .offset = 40,
+        .length = 50,
+        .applied_extra_verification_length_per_side = 2
+    };
+
+    auto const narrowed = verification::internal::narrow_reference_span_to_verified_child(
+        reference_span_config,
+        pex_node,
+        child
+    );
+
+    // start: 60 - 10 - 5 - 2, end: 59 + 20 + 5 + 2
+    EXPECT_EQ(narrowed.offset, 43);
+    EXPECT_EQ(narrowed.length, 43);
+    EXPECT_EQ(narrowed.applied_extra_verification_length_per_side, 2);
+}
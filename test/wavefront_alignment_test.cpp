@@ -0,0 +1,155 @@
+#include <bit_parallel_alignment.hpp>
+#include <wavefront_alignment.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <seqan3/io/sam_file/detail/cigar.hpp>
+
+#include <gtest/gtest.h>
+
+TEST(wavefront_alignment, matches_bit_parallel_kernel) {
+    using namespace bit_parallel_alignment;
+
+    std::mt19937 random_engine(5);
+    std::uniform_int_distribution<int> rank_distribution(1, 4);
+
+    for (size_t query_length : { 1ul, 10ul, 64ul, 65ul, 130ul, 300ul }) {
+        std::vector<uint8_t> query(query_length);
+        std::ranges::generate(query, [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); });
+        std::vector<uint8_t> const reverse_query(query.rbegin(), query.rend());
+
+        // the reference contains a copy of the query with some substitutions, an N, an insertion and a deletion
+        std::vector<uint8_t> reference(query_length + 60);
+        std::ranges::generate(reference, [&] () { return static_cast<uint8_t>(rank_distribution(random_engine)); });
+        for (size_t i = 0; i < query_length; ++i) {
+            reference[30 + i] = i % 37 == 5 ? static_cast<uint8_t>(rank_distribution(random_engine)) : query[i];
+        }
+        reference[30 + query_length / 3] = 5;
+        reference.insert(reference.begin() + 30 + query_length / 4, 3);
+        reference.erase(reference.begin() + 30 + query_length / 2);
+
+        query_pattern const pattern(query);
+        query_pattern const reverse_pattern(reverse_query);
+
+        for (size_t num_allowed_errors = 0; num_allowed_errors < query_length; num_allowed_errors += 1 + num_allowed_errors) {
+            for (auto const direction : { sequence_direction::forward, sequence_direction::reverse }) {
+                auto const expected_end = bit_parallel_alignment::best_alignment_end(
+                    reference,
+                    direction == sequence_direction::forward ? pattern : reverse_pattern,
+                    num_allowed_errors,
+                    direction
+                );
+                auto const end = wavefront_alignment::best_alignment_end(
+                    reference, query, num_allowed_errors, direction
+                );
+
+                ASSERT_EQ(end.has_value(), expected_end.has_value());
+                if (end.has_value()) {
+                    EXPECT_EQ(end->num_errors, expected_end->num_errors);
+                    EXPECT_EQ(end->end_position, expected_end->end_position);
+                }
+            }
+
+            auto const expected_alignment = bit_parallel_alignment::best_alignment_with_cigar(
+                reference, pattern, num_allowed_errors
+            );
+            auto const alignment = wavefront_alignment::best_alignment_with_cigar(reference, query, num_allowed_errors);
+
+            ASSERT_EQ(alignment.has_value(), expected_alignment.has_value());
+            if (alignment.has_value()) {
+                EXPECT_EQ(alignment->num_errors, expected_alignment->num_errors);
+                EXPECT_EQ(alignment->start_position, expected_alignment->start_position);
+                EXPECT_TRUE(alignment->cigar == expected_alignment->cigar);
+            }
+        }
+    }
+}
+
+TEST(wavefront_alignment, ties_are_broken_like_bit_parallel_kernel) {
+    using namespace bit_parallel_alignment;
+
+    struct tie_case {
+        std::vector<uint8_t> query;
+        std::vector<uint8_t> reference;
+        size_t num_allowed_errors;
+        size_t expected_num_errors;
+        size_t expected_end_position;
+        size_t expected_start_position;
+        std::string expected_cigar;
+    };
+
+    std::vector<tie_case> const cases {
+        // exact matches ending at 4 and 9, the largest end position wins
+        { { 1,2,3,4 }, { 1,2,3,4,2,1,2,3,4 }, 1, 0, 9, 5, "4=" },
+        // one error at several end positions
+        { { 1,2,3,4 }, { 1,2,4,4,2,1,2,3,1,1 }, 1, 1, 9, 5, "3=1X" },
+        // a mismatch or an insertion at the beginning, both ending at 3
+        { { 2,1,3 }, { 1,1,3 }, 1, 1, 3, 0, "1X2=" },
+        // a mismatch or a deletion at the beginning, both ending at 4
+        { { 1,2,3 }, { 1,4,2,3 }, 1, 1, 4, 1, "1X2=" },
+        // a mismatch in the middle ending at 3 or an insertion ending at 2
+        { { 1,2,3 }, { 1,3,3 }, 1, 1, 3, 0, "1=1X1=" }
+    };
+
+    for (auto const& c : cases) {
+        std::vector<uint8_t> const reverse_query(c.query.rbegin(), c.query.rend());
+        query_pattern const pattern(c.query);
+        query_pattern const reverse_pattern(reverse_query);
+
+        auto const expected_end = bit_parallel_alignment::best_alignment_end(
+            c.reference, pattern, c.num_allowed_errors, sequence_direction::forward
+        );
+        auto const end = wavefront_alignment::best_alignment_end(
+            c.reference, c.query, c.num_allowed_errors, sequence_direction::forward
+        );
+
+        ASSERT_TRUE(expected_end.has_value());
+        ASSERT_TRUE(end.has_value());
+        EXPECT_EQ(expected_end->num_errors, c.expected_num_errors);
+        EXPECT_EQ(expected_end->end_position, c.expected_end_position);
+        EXPECT_EQ(end->num_errors, c.expected_num_errors);
+        EXPECT_EQ(end->end_position, c.expected_end_position);
+
+        auto const expected_start = bit_parallel_alignment::best_alignment_end(
+            c.reference, reverse_pattern, c.num_allowed_errors, sequence_direction::reverse
+        );
+        auto const start = wavefront_alignment::best_alignment_end(
+            c.reference, c.query, c.num_allowed_errors, sequence_direction::reverse
+        );
+
+        ASSERT_TRUE(expected_start.has_value());
+        ASSERT_TRUE(start.has_value());
+        EXPECT_EQ(start->num_errors, expected_start->num_errors);
+        EXPECT_EQ(start->end_position, expected_start->end_position);
+
+        auto const expected_alignment = bit_parallel_alignment::best_alignment_with_cigar(
+            c.reference, pattern, c.num_allowed_errors
+        );
+        auto const alignment = wavefront_alignment::best_alignment_with_cigar(
+            c.reference, c.query, c.num_allowed_errors
+        );
+
+        ASSERT_TRUE(expected_alignment.has_value());
+        ASSERT_TRUE(alignment.has_value());
+        EXPECT_EQ(expected_alignment->start_position, c.expected_start_position);
+        EXPECT_TRUE(expected_alignment->cigar == seqan3::detail::parse_cigar(c.expected_cigar));
+        EXPECT_EQ(alignment->num_errors, c.expected_num_errors);
+        EXPECT_EQ(alignment->start_position, c.expected_start_position);
+        EXPECT_TRUE(alignment->cigar == seqan3::detail::parse_cigar(c.expected_cigar));
+    }
+}
+
+TEST(wavefront_alignment, max_num_errors_cheaper_than_bit_parallel) {
+    using namespace wavefront_alignment;
+
+    // long high-identity query, where the band of the bit-parallel kernel is wide
+    size_t const cap = max_num_errors_cheaper_than_bit_parallel(17'400, 15'000, 1'200);
+    EXPECT_GT(cap, 0ul);
+    EXPECT_LT(cap, 1'200ul);
+
+    // short query, where the kernel only needs a single block
+    EXPECT_LE(max_num_errors_cheaper_than_bit_parallel(100, 50, 5), 5ul);
+}